@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Move.hpp"
+#include "Random.hpp"
+#include "SequenceModel.hpp"
+
+// Something that picks moves for a player. GameController asks its agent for a move on a worker thread,
+// handing it a copy of the game, so an agent may take as long as it likes without stalling the window.
+// An agent must only use what its player can see; engines that search should start from game.observe().
+class Agent
+{
+public:
+	virtual ~Agent() = default;
+
+	// Chooses one of the legal moves for the player to move. The game always has at least one.
+	virtual Move chooseMove(const SequenceModel& game) = 0;
+};
+
+// Plays a uniformly random legal move. The baseline every other agent is measured against.
+class RandomAgent : public Agent
+{
+public:
+	explicit RandomAgent(uint64_t seed) : rng(seed) { }
+
+	Move chooseMove(const SequenceModel& game) override
+	{
+		MoveList moves;
+		game.generateMoves(moves);
+		return moves[rng.nextBelow(moves.size)];
+	}
+
+private:
+	Random rng;
+};
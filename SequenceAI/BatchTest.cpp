@@ -0,0 +1,118 @@
+#include "Random.hpp"
+#include "SequenceBatch.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+// Plays a batch of games alongside the same games played one at a time by the model, choosing the same move in
+// each, and checks after every move that the two agree on the moves listed, the board, the hands and the result.
+// Then checks the random advance, which never lists the moves, plays what a policy picking from the list would.
+
+static bool sameGames(const SequenceBatch<SequenceModel>& a, const SequenceBatch<SequenceModel>& b, int game)
+{
+    bool same = a.isFinished(game) == b.isFinished(game) && a.getWinner(game) == b.getWinner(game)
+        && a.getPlayerIndex(game) == b.getPlayerIndex(game) && a.getDeckSize(game) == b.getDeckSize(game);
+    for (int t = 0; t < SequenceModel::NUM_TEAMS; t++)
+        same &= a.getTokens(game, t) == b.getTokens(game, t) && a.getFirstSequence(game, t) == b.getFirstSequence(game, t);
+    for (int p = 0; p < SequenceModel::NUM_PLAYERS; p++)
+    {
+        for (int i = 0; i < SequenceModel::HAND_SIZE; i++)
+            same &= a.getHandCard(game, p, i) == b.getHandCard(game, p, i);
+    }
+    return same;
+}
+
+static int checkRandomAdvance(int games)
+{
+    SequenceBatch<SequenceModel> counted(games, 1), listed(games, 1);
+    Random countedRng(3), listedRng(3);
+    for (int turn = 0;; turn++)
+    {
+        int running = counted.advance(countedRng);
+        int listedRunning = listed.advance([&listedRng](int, const MoveList& moves) { return (int)listedRng.nextBelow(moves.size); });
+        for (int g = 0; g < games; g++)
+        {
+            if (!sameGames(counted, listed, g))
+            {
+                printf("game %d turn %d: the random advance played a different move\n", g, turn);
+                return 1;
+            }
+        }
+        if (running != listedRunning)
+        {
+            printf("turn %d: the random advance has a different number of games running\n", turn);
+            return 1;
+        }
+        if (running == 0)
+            return 0;
+    }
+}
+
+int main()
+{
+    const int games = 500;
+    SequenceBatch<SequenceModel> batch(games, 1);
+    vector<SequenceModel> models;
+    for (int g = 0; g < games; g++)
+        models.emplace_back(1 + g);
+
+    Random rng(7);
+    vector<int> choices(games);
+    int failures = 0;
+    for (int turn = 0; failures == 0; turn++)
+    {
+        for (int g = 0; g < games && failures == 0; g++)
+        {
+            if (batch.isFinished(g))
+                continue;
+            MoveList expected, listed;
+            models[g].generateMoves(expected);
+            batch.generateMoves(g, listed);
+            bool same = expected.size == listed.size;
+            for (int i = 0; same && i < expected.size; i++)
+                same = expected[i] == listed[i];
+            if (!same)
+            {
+                printf("game %d turn %d: the batch lists different moves\n", g, turn);
+                failures++;
+            }
+            choices[g] = expected.size > 0 ? (int)rng.nextBelow(expected.size) : 0;
+            if (expected.size > 0)
+                models[g].makeMove(expected[choices[g]]);
+        }
+
+        int running = batch.advance([&choices](int game, const MoveList&) { return choices[game]; });
+
+        for (int g = 0; g < games && failures == 0; g++)
+        {
+            const SequenceModel::State& state = models[g].getState();
+            bool same = batch.getWinner(g) == state.winner && batch.getPlayerIndex(g) == state.toMove
+                && batch.getDeckSize(g) == state.deckSize;
+            for (int t = 0; t < SequenceModel::NUM_TEAMS; t++)
+                same &= batch.getTokens(g, t) == state.tokens[t] && batch.getFirstSequence(g, t) == state.firstSequence[t];
+            for (int p = 0; p < SequenceModel::NUM_PLAYERS; p++)
+            {
+                for (int i = 0; i < SequenceModel::HAND_SIZE; i++)
+                    same &= batch.getHandCard(g, p, i) == state.hands[p][i];
+            }
+            if (!same)
+            {
+                printf("game %d turn %d: the batch and the model disagree\n", g, turn);
+                failures++;
+            }
+        }
+        if (running == 0)
+            break;
+    }
+
+    if (failures == 0)
+        failures += checkRandomAdvance(games);
+
+    if (failures > 0)
+        return 1;
+    printf("All batch checks passed\n");
+    return 0;
+}
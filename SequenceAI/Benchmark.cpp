@@ -0,0 +1,200 @@
+#include "ISMCTS.hpp"
+#include "MCTS.hpp"
+#include "RootParallel.hpp"
+#include "SequenceBatch.hpp"
+#include "SequenceModel.hpp"
+#include "TreeParallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+using namespace std;
+
+// Every heap allocation made by the program, so each benchmark can show how many its loop made
+static atomic<long long> allocations(0);
+
+// Somewhere to put results the benchmarks would otherwise throw away, so the compiler can't skip the work
+static volatile uint64_t sink;
+
+void* operator new(size_t size)
+{
+    allocations++;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+struct Result
+{
+    long long operations;
+    long long allocations;
+    double seconds;
+};
+
+static void report(const char* name, const Result& result)
+{
+    printf("%-28s %12lld ops %10.1f ns/op %8lld allocations\n", name, result.operations,
+        result.seconds * 1e9 / (double)result.operations, result.allocations);
+}
+
+// Runs body() over and over on fresh games until it has done at least the given number of operations.
+// body returns how many operations it did, or 0 once its game is over.
+template <class Body>
+static Result measure(long long operations, Body body)
+{
+    Result result{ 0, 0, 0.0 };
+    uint64_t seed = 1;
+    while (result.operations < operations)
+    {
+        SequenceModel game(seed++);
+
+        long long before = allocations;
+        auto start = chrono::steady_clock::now();
+        while (long long done = body(game))
+            result.operations += done;
+        result.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.allocations += allocations - before;
+    }
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    long long operations = argc > 1 ? atoll(argv[1]) : 2000000;
+    Random rng(1);
+    MoveList moves;
+
+    report("generateMoves", measure(operations, [&](SequenceModel& game) -> long long {
+        if (game.generateMoves(moves) == 0)
+            return 0;
+        game.makeMove(moves[rng.nextBelow(moves.size)]);
+        return 1;
+    }));
+
+    // makeMove scores any sequences the move makes, which is where the old checkWin went
+    report("makeMove + unmakeMove", measure(operations, [&](SequenceModel& game) -> long long {
+        if (game.generateMoves(moves) == 0)
+            return 0;
+        MoveUndo undo;
+        for (const Move& move : moves)
+        {
+            game.makeMove(move, undo);
+            game.unmakeMove(undo);
+        }
+        game.makeMove(moves[rng.nextBelow(moves.size)]);
+        return moves.size;
+    }));
+
+    // The path the view takes when the board is clicked
+    report("clickCard", measure(operations, [&](SequenceModel& game) -> long long {
+        if (game.generateMoves(moves) == 0)
+            return 0;
+        const Move& move = moves[rng.nextBelow(moves.size)];
+        if (move.type == MoveType::EXCHANGE)
+        {
+            game.makeMove(move);
+            return 1;
+        }
+        Card used;
+        game.clickCard(move.cell % constants::GAME_BOARD_SIZE, move.cell / constants::GAME_BOARD_SIZE, &used);
+        return 1;
+    }));
+
+    report("observe + determinize", measure(operations / 10, [&](SequenceModel& game) -> long long {
+        if (game.generateMoves(moves) == 0)
+            return 0;
+        SequenceModel sample = SequenceModel::determinize(game.observe(game.getPlayerIndex()), rng);
+        sink = sink ^ sample.getHash();
+        game.makeMove(moves[rng.nextBelow(moves.size)]);
+        return 1;
+    }));
+
+    // Whole games played side by side. The batch allocates its columns once, up front.
+    const int games = 1024;
+    Result batch{ 0, 0, 0.0 };
+    for (uint64_t seed = 0; batch.operations < operations; seed += games)
+    {
+        SequenceBatch<SequenceModel> simulation(games, seed);
+        long long before = allocations;
+        auto start = chrono::steady_clock::now();
+        while (int running = simulation.advance(rng))
+            batch.operations += running;
+        batch.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        batch.allocations += allocations - before;
+    }
+    report("SequenceBatch::advance", batch);
+
+    // Tree search from fresh deals. Each iteration is one playout, so this is the playout rate searches run at.
+    MCTS<SequenceModel> mcts(1);
+    Result search{ 0, 0, 0.0 };
+    for (uint64_t seed = 1; search.operations < operations / 20; seed++)
+    {
+        SequenceModel game(seed);
+        long long before = allocations;
+        SearchResult found = mcts.search(game, SearchLimits{ 2000, 0.0 });
+        search.operations += found.iterations;
+        search.seconds += found.seconds;
+        search.allocations += allocations - before;
+    }
+    report("MCTS iteration", search);
+
+    // The same from the first player's view, dealing the hidden cards again every iteration
+    ISMCTS<SequenceModel> ismcts(1);
+    Result hidden{ 0, 0, 0.0 };
+    for (uint64_t seed = 1; hidden.operations < operations / 20; seed++)
+    {
+        SequenceModel game(seed);
+        long long before = allocations;
+        SearchResult found = ismcts.search(game.observe(game.getPlayerIndex()), SearchLimits{ 2000, 0.0 });
+        hidden.operations += found.iterations;
+        hidden.seconds += found.seconds;
+        hidden.allocations += allocations - before;
+    }
+    report("ISMCTS iteration", hidden);
+
+    // Each parallel search on 1, 2, 4... threads up to the core count, for a fixed time from the same deal.
+    // Root parallelism shares nothing, so its rate should grow with the threads until the cores run out. Tree
+    // parallelism shares one tree, and the virtual loss hits and wasted expansions show what that costs.
+    int cores = max(1, (int)thread::hardware_concurrency());
+    SequenceModel deal(1);
+    SearchLimits sweep{ 0, 0.5 };
+    double baselines[3] = { 0.0, 0.0, 0.0 };
+    for (int threads = 1;; threads = min(threads * 2, cores))
+    {
+        RootParallel<ISMCTS<SequenceModel>> rootIsmcts(threads, 1, 0.7, 1 << 18);
+        RootParallel<MCTS<SequenceModel>> rootMcts(threads, 1, 0.7, 1 << 18);
+        TreeParallelMCTS<SequenceModel> treeMcts(threads, 1, 0.7, 1 << 20);
+        double rates[3] = {
+            rootIsmcts.search(deal.observe(deal.getPlayerIndex()), sweep).iterationsPerSecond(),
+            rootMcts.search(deal.observe(deal.getPlayerIndex()), sweep).iterationsPerSecond(),
+            treeMcts.search(deal, sweep).iterationsPerSecond()
+        };
+        if (threads == 1)
+            copy(rates, rates + 3, baselines);
+
+        const TreeParallelStats& stats = treeMcts.getStats();
+        printf("%3d threads  root ISMCTS %9.0f/s %5.2fx  root MCTS %9.0f/s %5.2fx  tree MCTS %9.0f/s %5.2fx"
+            "  %lld virtual loss hits %lld wasted expansions\n", threads,
+            rates[0], rates[0] / baselines[0], rates[1], rates[1] / baselines[1], rates[2], rates[2] / baselines[2],
+            stats.virtualLossHits, stats.wastedExpansions);
+        if (threads == cores)
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// A set of board cells stored as a 128-bit mask. Bit i corresponds to the cell at
+// index i = y * GAME_BOARD_SIZE + x, so the 100 cells of the board fit in two words.
+struct Bitboard
+{
+	uint64_t lo;
+	uint64_t hi;
+
+	constexpr Bitboard() : lo(0), hi(0) { }
+	constexpr Bitboard(uint64_t lo, uint64_t hi) : lo(lo), hi(hi) { }
+
+	// A mask containing only the given cell
+	static constexpr Bitboard cell(int index)
+	{
+		return index < 64 ? Bitboard(1ull << index, 0) : Bitboard(0, 1ull << (index - 64));
+	}
+
+	constexpr bool test(int index) const
+	{
+		return index < 64 ? (lo >> index) & 1 : (hi >> (index - 64)) & 1;
+	}
+
+	constexpr void set(int index)
+	{
+		if (index < 64)
+			lo |= 1ull << index;
+		else
+			hi |= 1ull << (index - 64);
+	}
+
+	constexpr void reset(int index)
+	{
+		if (index < 64)
+			lo &= ~(1ull << index);
+		else
+			hi &= ~(1ull << (index - 64));
+	}
+
+	constexpr bool empty() const { return (lo | hi) == 0; }
+
+	// Number of cells in the set
+	int count() const { return popcount(lo) + popcount(hi); }
+
+	// Index of the lowest cell in the set. The set must not be empty.
+	int lowest() const { return lo ? lowestBit(lo) : 64 + lowestBit(hi); }
+
+	// Index of the cell n places above the lowest, so nth(0) is lowest(). n must be less than count().
+	int nth(int n) const
+	{
+		int low = popcount(lo);
+		return n < low ? nthBit(lo, n) : 64 + nthBit(hi, n - low);
+	}
+
+	// Removes the lowest cell from the set and returns its index. The set must not be empty.
+	int popLowest()
+	{
+		int index = lowest();
+		if (lo)
+			lo &= lo - 1;
+		else
+			hi &= hi - 1;
+		return index;
+	}
+
+	constexpr Bitboard operator&(const Bitboard& other) const { return Bitboard(lo & other.lo, hi & other.hi); }
+	constexpr Bitboard operator|(const Bitboard& other) const { return Bitboard(lo | other.lo, hi | other.hi); }
+	constexpr Bitboard operator^(const Bitboard& other) const { return Bitboard(lo ^ other.lo, hi ^ other.hi); }
+	constexpr Bitboard operator~() const { return Bitboard(~lo, ~hi); }
+
+	constexpr Bitboard& operator&=(const Bitboard& other) { lo &= other.lo; hi &= other.hi; return *this; }
+	constexpr Bitboard& operator|=(const Bitboard& other) { lo |= other.lo; hi |= other.hi; return *this; }
+	constexpr Bitboard& operator^=(const Bitboard& other) { lo ^= other.lo; hi ^= other.hi; return *this; }
+
+	constexpr bool operator==(const Bitboard& other) const { return lo == other.lo && hi == other.hi; }
+	constexpr bool operator!=(const Bitboard& other) const { return !(*this == other); }
+
+	static int popcount(uint64_t x)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		return (int)__popcnt64(x);
+#elif defined(__GNUC__)
+		return __builtin_popcountll(x);
+#else
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+	}
+
+	// Index of the set bit n places above the lowest. Finds the byte holding it from the running bit counts of
+	// the bytes, then steps through that byte's bits.
+	static int nthBit(uint64_t x, int n)
+	{
+		uint64_t counts = x - ((x >> 1) & 0x5555555555555555ull);
+		counts = (counts & 0x3333333333333333ull) + ((counts >> 2) & 0x3333333333333333ull);
+		counts = (counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0full;
+		uint64_t totals = counts * 0x0101010101010101ull;
+		int shift = 0;
+		while ((int)(totals >> shift & 0xff) <= n)
+			shift += 8;
+		if (shift > 0)
+			n -= (int)(totals >> (shift - 8) & 0xff);
+		uint64_t byte = x >> shift & 0xff;
+		for (; n > 0; n--)
+			byte &= byte - 1;
+		return shift + lowestBit(byte);
+	}
+
+	static int lowestBit(uint64_t x)
+	{
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long index;
+		_BitScanForward64(&index, x);
+		return (int)index;
+#elif defined(__GNUC__)
+		return __builtin_ctzll(x);
+#else
+		return popcount((x & (0 - x)) - 1);
+#endif
+	}
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Bitboard.hpp"
+#include "Constants.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+// Masks and lookup tables derived from the layout of constants::GAME_BOARD
+namespace board {
+	const int NUM_CELLS = constants::GAME_BOARD_SIZE * constants::GAME_BOARD_SIZE;
+
+	constexpr int cellIndex(int x, int y)
+	{
+		return y * constants::GAME_BOARD_SIZE + x;
+	}
+
+	constexpr Bitboard makeWildCells()
+	{
+		Bitboard wild;
+		for (int y = 0; y < constants::GAME_BOARD_SIZE; y++)
+			for (int x = 0; x < constants::GAME_BOARD_SIZE; x++)
+				if (constants::GAME_BOARD[y][x] == constants::WILD)
+					wild.set(cellIndex(x, y));
+		return wild;
+	}
+
+	// The corner cells, which count as a token for every player
+	constexpr Bitboard WILD_CELLS = makeWildCells();
+
+	constexpr Bitboard makeAllCells()
+	{
+		Bitboard all;
+		for (int i = 0; i < NUM_CELLS; i++)
+			all.set(i);
+		return all;
+	}
+
+	// Every cell of the board, for trimming the unused high bits off complemented masks
+	constexpr Bitboard ALL_CELLS = makeAllCells();
+
+	// Every run of a sequence's length of cells along a row, column or diagonal is a "window"
+	const int NUM_DIRECTIONS = 4;
+	const int DIRECTION_X[NUM_DIRECTIONS] = { 1, 0, 1, 1 };
+	const int DIRECTION_Y[NUM_DIRECTIONS] = { 0, 1, 1, -1 };
+
+	constexpr int windowsPerLine(int sequenceLength)
+	{
+		return constants::GAME_BOARD_SIZE - sequenceLength + 1;
+	}
+
+	constexpr int numWindows(int sequenceLength)
+	{
+		return 2 * constants::GAME_BOARD_SIZE * windowsPerLine(sequenceLength) + 2 * windowsPerLine(sequenceLength) * windowsPerLine(sequenceLength);
+	}
+
+	template <int SequenceLength>
+	struct WindowTable
+	{
+		static const int NUM_WINDOWS = numWindows(SequenceLength);
+		static const int MAX_CELL_WINDOWS = NUM_DIRECTIONS * SequenceLength;
+		// Short sequences make more windows than a byte can number
+		using Index = typename std::conditional<NUM_WINDOWS <= 256, uint8_t, uint16_t>::type;
+
+		// The cells covered by each window
+		Bitboard masks[NUM_WINDOWS];
+		// The windows passing through each cell
+		Index cellWindows[NUM_CELLS][MAX_CELL_WINDOWS];
+		uint8_t cellWindowCount[NUM_CELLS];
+		// The number of wild corners in each window
+		uint8_t wildCount[NUM_WINDOWS];
+	};
+
+	template <int SequenceLength>
+	constexpr WindowTable<SequenceLength> makeWindowTable()
+	{
+		using Index = typename WindowTable<SequenceLength>::Index;
+
+		WindowTable<SequenceLength> table{};
+		int window = 0;
+		for (int d = 0; d < NUM_DIRECTIONS; d++)
+		{
+			// Windows through any one cell are listed from left to right (top to bottom for columns)
+			for (int startX = 0; startX < constants::GAME_BOARD_SIZE; startX++)
+			{
+				for (int startY = 0; startY < constants::GAME_BOARD_SIZE; startY++)
+				{
+					int endX = startX + DIRECTION_X[d] * (SequenceLength - 1);
+					int endY = startY + DIRECTION_Y[d] * (SequenceLength - 1);
+					if (endX < 0 || endX >= constants::GAME_BOARD_SIZE || endY < 0 || endY >= constants::GAME_BOARD_SIZE)
+						continue;
+
+					for (int i = 0; i < SequenceLength; i++)
+					{
+						int cell = cellIndex(startX + DIRECTION_X[d] * i, startY + DIRECTION_Y[d] * i);
+						table.masks[window].set(cell);
+						table.cellWindows[cell][table.cellWindowCount[cell]++] = (Index)window;
+						if (WILD_CELLS.test(cell))
+							table.wildCount[window]++;
+					}
+					window++;
+				}
+			}
+		}
+		return table;
+	}
+
+	// The window table for each sequence length in use, built once at compile time
+	template <int SequenceLength>
+	constexpr WindowTable<SequenceLength> WINDOWS = makeWindowTable<SequenceLength>();
+
+	// Every card except the jacks appears on exactly two cells of the board
+	const int NUM_CARDS = constants::NUM_SUITS * constants::NUM_FACES;
+	const int CELLS_PER_CARD = 2;
+
+	// Packed card value for an empty hand slot or an exhausted deck
+	const uint8_t NO_CARD = 0xFF;
+	// Card value for a slot in a hand the observer can't see
+	const uint8_t HIDDEN_CARD = 0xFE;
+
+	// The deck is made of whole packs, so a hand can hold this many copies of a card
+	const int COPIES_PER_CARD = constants::DECK_SIZE / NUM_CARDS;
+
+	constexpr int cardIndex(int suit, int face)
+	{
+		return suit * constants::NUM_FACES + face;
+	}
+
+	struct CardTable
+	{
+		// The cell indices of each card, or -1 for jacks
+		int8_t cells[NUM_CARDS][CELLS_PER_CARD];
+		// The same cells as a mask, empty for jacks
+		Bitboard masks[NUM_CARDS];
+		// The card shown on each cell, or NO_CARD for the wild corners
+		uint8_t cellCards[NUM_CELLS];
+	};
+
+	constexpr CardTable makeCardTable()
+	{
+		CardTable table{};
+		int found[NUM_CARDS] = {};
+		for (int card = 0; card < NUM_CARDS; card++)
+			for (int i = 0; i < CELLS_PER_CARD; i++)
+				table.cells[card][i] = -1;
+		for (int i = 0; i < NUM_CELLS; i++)
+			table.cellCards[i] = NO_CARD;
+
+		for (int y = 0; y < constants::GAME_BOARD_SIZE; y++)
+		{
+			for (int x = 0; x < constants::GAME_BOARD_SIZE; x++)
+			{
+				int card = constants::GAME_BOARD[y][x];
+				if (card == constants::WILD)
+					continue;
+				table.cells[card][found[card]++] = (int8_t)cellIndex(x, y);
+				table.masks[card].set(cellIndex(x, y));
+				table.cellCards[cellIndex(x, y)] = (uint8_t)card;
+			}
+		}
+		return table;
+	}
+
+	constexpr CardTable CARDS = makeCardTable();
+
+	// Two-eyed jacks are wild and may be placed on any open cell
+	constexpr bool isTwoEyedJack(int card)
+	{
+		return card == constants::SUIT_DIAMOND + constants::FACE_JACK || card == constants::SUIT_CLUB + constants::FACE_JACK;
+	}
+
+	// One-eyed jacks remove an opponent's token
+	constexpr bool isOneEyedJack(int card)
+	{
+		return card == constants::SUIT_HEART + constants::FACE_JACK || card == constants::SUIT_SPADE + constants::FACE_JACK;
+	}
+
+	// Sets of cards with one bit per card index
+	constexpr uint64_t TWO_EYED_JACKS = 1ull << (constants::SUIT_DIAMOND + constants::FACE_JACK) | 1ull << (constants::SUIT_CLUB + constants::FACE_JACK);
+	constexpr uint64_t ONE_EYED_JACKS = 1ull << (constants::SUIT_HEART + constants::FACE_JACK) | 1ull << (constants::SUIT_SPADE + constants::FACE_JACK);
+}
@@ -1,5 +1,6 @@
 #include "Card.hpp"
-#include "constants.hpp"
+#include "Constants.hpp"
+#include "Board.hpp"
 
 Card::Card() : Card(0, 0) { }
 
@@ -10,15 +11,20 @@ Card::Card(int suit, int face) : suit(suit), face(face)
 
 const Card Card::invalid = Card(-1, -1);
 
-IntRect Card::getCardTextureBounds()
+// Gets the packed card index (suit * NUM_FACES + face), or board::NO_CARD for the invalid card.
+int Card::getIndex() const
 {
-	return getCardTextureBounds(suit, face);
+	if (*this == invalid)
+		return board::NO_CARD;
+	return board::cardIndex(suit, face);
 }
 
-// Gets the card's bounds on the texture sheet.
-IntRect Card::getCardTextureBounds(int suit, int face)
+// Unpacks a card index, giving the invalid card for board::NO_CARD.
+Card Card::fromIndex(int index)
 {
-	return IntRect(face * constants::CARD_WIDTH, suit * constants::CARD_HEIGHT, constants::CARD_WIDTH, constants::CARD_HEIGHT);
+	if (index < 0 || index >= board::NUM_CARDS)
+		return invalid;
+	return Card(index / constants::NUM_FACES, index % constants::NUM_FACES);
 }
 
 bool Card::operator==(const Card &other) const
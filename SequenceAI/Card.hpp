@@ -1,8 +1,5 @@
 #pragma once
 
-#include <SFML\Graphics.hpp>
-
-using namespace sf;
 using namespace std;
 
 class Card
@@ -13,9 +10,9 @@ public:
 
 	Card();
 	Card(int suit, int face);
-	IntRect getCardTextureBounds();
 
-	static IntRect getCardTextureBounds(int suit, int face);
+	int getIndex() const;
+	static Card fromIndex(int index);
 
 	bool operator==(const Card&) const;
 
@@ -59,8 +59,14 @@ namespace constants {
 	const int DECK_SIZE = 52 * 2;
 	const int HAND_SIZE = 7;
 	const int NUM_PLAYERS = 2;
+	const int NUM_TEAMS = 2;
 	const int P1 = 0;
 	const int P2 = 1;
+	// The player the computer plays for, and how long it thinks about each move
+	const int AI_PLAYER = P2;
+	const float AI_SECONDS_PER_MOVE = 1.f;
+	// ISMCTS grows about 35k nodes a second per thread, so this leaves each search tree twice that room
+	const int AI_NODES_PER_THREAD = (int)(AI_SECONDS_PER_MOVE * 70000);
 
 	const int SEQUENCE_LENGTH = 5;
 
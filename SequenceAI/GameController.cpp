@@ -3,17 +3,25 @@
 #include <algorithm>
 #include <ctime>
 #include <cstdlib>
+#include <random>
+#include <thread>
 
 using namespace std;
 using namespace sf;
 
-GameController::GameController() : view(*this)
+// The agent leaves one core for drawing, and sizes its trees to what it can grow in its time.
+// It gets a seed of its own: the game's seed would rebuild the deck and every hand.
+GameController::GameController() : view(*this), agent(new ParallelIsmctsAgent(max(1, (int)thread::hardware_concurrency() - 1),
+    ((uint64_t)random_device()() << 32) | random_device()(),
+    SearchLimits{ 0, constants::AI_SECONDS_PER_MOVE }, constants::AI_NODES_PER_THREAD))
 {
     //reset();
 }
 
 void GameController::update(RenderWindow& window, float elapsed)
 {
+    updateAgent();
+
     if (!view.isAnimating())
         view.update(window, elapsed);
     else
@@ -30,9 +38,23 @@ int GameController::clickCard(int x, int y, Card* usedCard)
     return model.clickCard(x, y, usedCard);
 }
 
-bool GameController::checkWin(int player, int placedX, int placedY)
+// Plays a move chosen elsewhere than the board, returning the index in the hand of the card it used
+int GameController::playMove(const Move& move, Card* usedCard)
+{
+    *usedCard = Card::fromIndex(move.card);
+    model.makeMove(move);
+    return move.handIndex;
+}
+
+// Finds the exchange of the card in the given slot of the current player's hand, if it's dead and they may exchange
+bool GameController::findExchange(int handIndex, Move& move) const
 {
-    return model.checkWin(player, placedX, placedY);
+    int player = model.getPlayerIndex();
+    int card = model.handCard(player, handIndex);
+    if (card == board::NO_CARD || !model.canExchange() || !model.isDeadCard(card))
+        return false;
+    move = Move{ MoveType::EXCHANGE, (uint8_t)handIndex, (uint8_t)card, board::NO_CARD };
+    return true;
 }
 
 int GameController::gameIsWon() const
@@ -40,6 +62,11 @@ int GameController::gameIsWon() const
     return model.gameIsWon();
 }
 
+bool GameController::gameIsOver() const
+{
+    return model.gameIsOver();
+}
+
 int GameController::getPlayerIndex() const
 {
     return model.getPlayerIndex();
@@ -50,17 +77,56 @@ Card GameController::getHandCard(int player, int index) const
     return model.getHandCard(player, index);
 }
 
-vector<int> GameController::getTokenPositions(int player) const
+bool GameController::inFirstSequence(int player, int x, int y) const
 {
-    return model.getTokenPositions(player);
+    return model.inFirstSequence(player, x, y);
 }
 
-bool GameController::inFirstSequence(int player, int x, int y) const
+const Bitboard& GameController::getTokens(int player) const
 {
-    return model.inFirstSequence(player, x, y);
+    return model.getTokens(player);
+}
+
+int GameController::owner(int x, int y) const
+{
+    return model.owner(x, y);
+}
+
+int GameController::getLastToken() const
+{
+    return model.getLastToken();
 }
 
 bool GameController::needDoubleUpdate() const
 {
     return view.needDoubleUpdate();
-}
\ No newline at end of file
+}
+
+void GameController::setAgent(unique_ptr<Agent> agent)
+{
+    // Let any search in progress finish with the old agent first
+    if (agentMove.valid())
+        agentMove.wait();
+    agentMove = future<Move>();
+    this->agent = move(agent);
+}
+
+bool GameController::isAgentTurn() const
+{
+    return agent && model.getPlayerIndex() == constants::AI_PLAYER && !model.gameIsOver();
+}
+
+void GameController::updateAgent()
+{
+    // Start thinking as soon as the turn comes round, even while the last move is still animating.
+    // The agent works on its own copy of the game, so the window keeps drawing from the model meanwhile.
+    if (!agentMove.valid() && isAgentTurn())
+    {
+        Agent* thinker = agent.get();
+        agentMove = async(launch::async, [thinker, game = model]() { return thinker->chooseMove(game); });
+    }
+
+    // Play the move once it's ready and the board has stopped moving
+    if (agentMove.valid() && !view.isAnimating() && agentMove.wait_for(chrono::seconds(0)) == future_status::ready)
+        view.playMove(agentMove.get());
+}
@@ -1,11 +1,15 @@
 #pragma once
 
-#include <SFML\Graphics.hpp>
+#include <SFML/Graphics.hpp>
+#include "Agent.hpp"
 #include "Card.hpp"
 #include "Constants.hpp"
 #include "SequenceModel.hpp"
 #include "GameView.hpp"
+#include "RootParallel.hpp"
 
+#include <future>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -20,17 +24,32 @@ public:
 	void draw(RenderWindow&);
 
 	int clickCard(int x, int y, Card* usedCard);
-	bool checkWin(int player, int placedX, int placedY);
+	int playMove(const Move& move, Card* usedCard);
+	bool findExchange(int handIndex, Move& move) const;
 	int gameIsWon() const;
+	bool gameIsOver() const;
 
 	int getPlayerIndex() const;
 	Card getHandCard(int player, int index) const;
-	vector<int> getTokenPositions(int player) const;
 	bool inFirstSequence(int player, int x, int y) const;
+	const Bitboard& getTokens(int player) const;
+	int owner(int x, int y) const;
+	int getLastToken() const;
 
 	bool needDoubleUpdate() const;
 
+	void setAgent(unique_ptr<Agent> agent);
+	bool isAgentTurn() const;
+
 private:
 	GameView view;
 	SequenceModel model;
+
+	// Plays for constants::AI_PLAYER
+	unique_ptr<Agent> agent;
+	// The move the agent is working out on its worker thread, if it's thinking.
+	// Declared last so it's destroyed first, waiting for the agent to finish before the agent is deleted.
+	future<Move> agentMove;
+
+	void updateAgent();
 };
\ No newline at end of file
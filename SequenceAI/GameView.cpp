@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <ctime>
 #include <cstdlib>
+#include <cmath>
 #include <functional>
 
 using namespace std;
@@ -65,7 +66,7 @@ void GameView::loadContent()
         for (int face = 0; face < constants::NUM_FACES; face++)
         {
             cards[suit][face].setTexture(cardSheet);
-            cards[suit][face].setTextureRect(Card::getCardTextureBounds(suit, face));
+            cards[suit][face].setTextureRect(getCardTextureBounds(suit, face));
         }
     }
 
@@ -83,12 +84,23 @@ void GameView::update(RenderWindow& window, float elapsed)
 void GameView::clickCard(int x, int y)
 {
     // Try to place a token
+    int player = controller.getPlayerIndex();
     int clicked = controller.clickCard(x, y, usedCard);
     if (clicked != constants::INVALID_CARD)
     {
-        startDiscardAnimation(1 - controller.getPlayerIndex(), clicked, x, y);
+        startDiscardAnimation(player, clicked, x, y);
     }
-    controller.checkWin(1 - controller.getPlayerIndex(), x, y);
+}
+
+// Plays and animates a move that didn't come from a click, such as the AI's
+void GameView::playMove(const Move& move)
+{
+    int player = controller.getPlayerIndex();
+    int handIndex = controller.playMove(move, usedCard);
+    if (move.type == MoveType::EXCHANGE)
+        startDiscardAnimation(player, handIndex, -1, -1);
+    else
+        startDiscardAnimation(player, handIndex, move.cell % constants::GAME_BOARD_SIZE, move.cell / constants::GAME_BOARD_SIZE);
 }
 
 IntRect GameView::getHandRect(int player, int index)
@@ -105,24 +117,10 @@ IntRect GameView::getHandRect(int player, int index)
     return IntRect(position, size);
 }
 
-vector<int> GameView::getBoardIndices(int suit, int face)
+// Gets the card's bounds on the texture sheet.
+IntRect GameView::getCardTextureBounds(int suit, int face)
 {
-    int cardID = suit * constants::NUM_FACES + face;
-    vector<int> indices;
-
-    for (int y = 0; y < constants::GAME_BOARD_SIZE; y++)
-    {
-        for (int x = 0; x < constants::GAME_BOARD_SIZE; x++)
-        {
-            int boardCard = constants::GAME_BOARD[y][x];
-            if (boardCard == cardID)
-            {
-                indices.push_back(y * constants::GAME_BOARD_SIZE + x);
-            }
-        }
-    }
-
-    return indices;
+    return IntRect(face * constants::CARD_WIDTH, suit * constants::CARD_HEIGHT, constants::CARD_WIDTH, constants::CARD_HEIGHT);
 }
 
 void GameView::highlightSelectedCard(RenderWindow& window)
@@ -130,7 +128,7 @@ void GameView::highlightSelectedCard(RenderWindow& window)
     highlightedCard = constants::HIGHLIGHT_NONE;
 
     // Don't highlight if the game is over
-    if (controller.gameIsWon() != -1)
+    if (controller.gameIsOver())
         return;
 
     for (int p = constants::P1; p <= constants::P2; p++)
@@ -167,12 +165,24 @@ void GameView::highlightSelectedCard(RenderWindow& window)
 
 void GameView::checkForCardClick(RenderWindow& window)
 {
-    // Don't highlight if the game is over
-    if (controller.gameIsWon() != -1)
+    // Don't highlight if the game is over, and leave the AI's turn to the AI
+    if (controller.gameIsOver() || controller.isAgentTurn())
         return;
 
     if (Mouse::isButtonPressed(Mouse::Button::Left))
     {
+        // Clicking a dead card in hand exchanges it
+        int player = controller.getPlayerIndex();
+        for (int i = 0; i < constants::HAND_SIZE; i++)
+        {
+            Move exchange;
+            if (getHandRect(player, i).contains(Mouse::getPosition(window)) && controller.findExchange(i, exchange))
+            {
+                playMove(exchange);
+                return;
+            }
+        }
+
         for (int y = 0; y < constants::GAME_BOARD_SIZE; y++)
         {
             for (int x = 0; x < constants::GAME_BOARD_SIZE; x++)
@@ -271,10 +281,14 @@ void GameView::startDiscardAnimation(int player, int handIndex, int x, int y)
     if (card.face == constants::FACE_JACK && (card.suit == constants::SUIT_HEART / 13 || card.suit == constants::SUIT_SPADE / 13))
         removingToken = true;
 
+    // An exchange (x == -1) goes straight from the discard to drawing a new card
     function<void()> afterDiscard = [this, cardSprite, player, x, y, handIndex, removingToken]() {
         topDiscard = Sprite(cardSprite);
         tempTokenPos = -1;
-        startTokenPlaceAnimation(player, x, y, handIndex, removingToken);
+        if (x == -1)
+            startDrawCardAnimation(player, handIndex);
+        else
+            startTokenPlaceAnimation(player, x, y, handIndex, removingToken);
     };
 
     startAnimation(cardSprite, Vector2f(handRect.left, handRect.top),
@@ -284,7 +298,7 @@ void GameView::startDiscardAnimation(int player, int handIndex, int x, int y)
     discardPlayer = player;
     discardIndex = handIndex;
     
-    drawLastToken = removingToken;
+    drawLastToken = removingToken || x == -1;
     drawNewlyDrawnCard = false;
 
     if (removingToken)
@@ -384,11 +398,10 @@ void GameView::drawBoard(RenderWindow& window)
             card.setPosition(getCardPosition(x, y));
 
             // Check whether this card has a token on it
-            auto tokensP1 = controller.getTokenPositions(constants::P1);
-            auto tokensP2 = controller.getTokenPositions(constants::P2);
-            bool tokenedP1 = find(begin(tokensP1), end(tokensP1), y * constants::GAME_BOARD_SIZE + x) != end(tokensP1);
-            bool tokenedP2 = find(begin(tokensP2), end(tokensP2), y * constants::GAME_BOARD_SIZE + x) != end(tokensP2);
-            bool tokened = tokenedP1 || tokenedP2;
+            int owner = controller.owner(x, y);
+            bool tokenedP1 = owner == constants::P1;
+            bool tokenedP2 = owner == constants::P2;
+            bool tokened = owner != -1;
 
             // If the card specifically is selected, a wildcard jack is selected, or it's tokened and a remove jack is selected,
             if (cardID != constants::WILD && (
@@ -408,17 +421,18 @@ void GameView::drawBoard(RenderWindow& window)
 
     for (int p = constants::P1; p <= constants::P2; p++)
     {
-        auto tokens = controller.getTokenPositions(p);
-        for (int t = 0; t < (drawLastToken || p != discardPlayer ? tokens.size() : tokens.size() - 1); t++)
-        {
-            drawToken(window, p, tokens[t]);
-        }
+        Bitboard tokens = controller.getTokens(p);
+        // Hold back the token being placed until its card lands
+        if (!drawLastToken && p == discardPlayer && controller.getLastToken() != -1)
+            tokens.reset(controller.getLastToken());
+        while (!tokens.empty())
+            drawToken(window, p, tokens.popLowest());
     }
     if (tempTokenPos != -1)
         drawToken(window, controller.getPlayerIndex(), tempTokenPos);
 
     // Only draw discard and draw if game is still going on
-    if (currentlyAnimating || controller.gameIsWon() == -1)
+    if (currentlyAnimating || !controller.gameIsOver())
     {
         Sprite topDraw(cardBack);
 
@@ -489,9 +503,11 @@ void GameView::drawInformation(RenderWindow& window)
     window.draw(tip1);
     window.draw(tip2);
 
-    if (!currentlyAnimating && controller.gameIsWon() != -1)
+    if (!currentlyAnimating && controller.gameIsOver())
     {
-        Text won{ controller.gameIsWon() == 0 ? "YOU WIN!" : "AI WINS!", font };
+        // A game that ends with nobody able to move is a draw
+        int winner = controller.gameIsWon();
+        Text won{ winner == -1 ? "DRAW!" : winner == 0 ? "YOU WIN!" : "AI WINS!", font };
         won.setFillColor(Color::Black);
         won.setCharacterSize(constants::WIN_TEXT_SIZE);
         won.setPosition(constants::WIN_OFFSET_X - won.getGlobalBounds().width / 2.f, constants::WIN_OFFSET_Y);
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <SFML\Graphics.hpp>
+#include <SFML/Graphics.hpp>
+#include "Board.hpp"
 #include "Card.hpp"
 #include "Constants.hpp"
 #include "SequenceModel.hpp"
@@ -28,6 +29,8 @@ public:
 
 	bool needDoubleUpdate() const;
 
+	void playMove(const Move& move);
+
 	~GameView();
 
 private:
@@ -53,8 +56,8 @@ private:
 	Vector2f getCardPosition(int x, int y);
 	IntRect getCardRect(int x, int y);
 	IntRect getHandRect(int player, int index);
+	static IntRect getCardTextureBounds(int suit, int face);
 
-	vector<int> getBoardIndices(int suit, int face);
 	void highlightSelectedCard(RenderWindow&);
 	void checkForCardClick(RenderWindow&);
 
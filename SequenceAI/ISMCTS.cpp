@@ -0,0 +1,183 @@
+#include "ISMCTS.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+template <class Rules>
+ISMCTS<Rules>::ISMCTS(uint64_t seed, double exploration, int maxNodes) : maxNodes(maxNodes), exploration(exploration), rng(seed),
+    moveSlots(NUM_KEYS, -1)
+{
+    if (maxNodes < 1)
+        throw invalid_argument("ISMCTS needs room for at least the root node");
+    nodes.reserve(maxNodes);
+}
+
+template <class Rules>
+SearchResult ISMCTS<Rules>::search(const Observation& observation, const SearchLimits& limits)
+{
+    if (limits.iterations <= 0 && limits.seconds <= 0.0)
+        throw invalid_argument("search needs an iteration or time limit");
+
+    // The observer's own hand is in the observation, so their moves can be listed without dealing the rest
+    Rules visible(observation.state);
+    if (observation.player != visible.getPlayerIndex())
+        throw invalid_argument("search must be made for the player to move");
+    if (visible.gameIsWon() != -1 || !visible.hasLegalMove())
+        throw invalid_argument("search needs a game with a legal move to play");
+
+    nodes.clear();
+    nodes.push_back(Node{ Move(), 0, -1, -1, 0, 0, 0.0 });
+
+    SearchClock clock(limits);
+    long long iterations = 0;
+    while (limits.iterations <= 0 || iterations < limits.iterations)
+    {
+        iterate(observation);
+        iterations++;
+        if (clock.expired(iterations))
+            break;
+    }
+    double elapsed = clock.elapsed();
+
+    // The observer's moves are legal in every deal, so all of them end up as children of the root
+    int best = nodes[0].firstChild;
+    for (int c = nodes[0].firstChild; c != -1; c = nodes[c].nextSibling)
+    {
+        if (nodes[c].visits > nodes[best].visits)
+            best = c;
+    }
+
+    if (best == -1)
+        return unsearchedResult(visible, iterations, elapsed, (int)nodes.size());
+    const Node& chosen = nodes[best];
+    return SearchResult{ chosen.move, iterations, elapsed, (int)nodes.size(), chosen.visits, chosen.value / chosen.visits };
+}
+
+template <class Rules>
+void ISMCTS<Rules>::getRootMoves(RootMoves& rootMoves) const
+{
+    rootMoves.size = 0;
+    for (int c = nodes[0].firstChild; c != -1; c = nodes[c].nextSibling)
+        rootMoves.moves[rootMoves.size++] = RootMove{ nodes[c].move, nodes[c].visits, nodes[c].value };
+}
+
+template <class Rules>
+void ISMCTS<Rules>::iterate(const Observation& observation)
+{
+    int path[constants::DECK_SIZE + 2];
+    int depth = 0;
+    path[depth++] = 0;
+
+    Rules game = Rules::determinize(observation, rng);
+    int node = 0;
+    MoveList moves;
+
+    while (game.generateMoves(moves) > 0)
+    {
+        for (int i = 0; i < moves.size; i++)
+            moveSlots[moveKey(moves[i])] = (int16_t)i;
+
+        // Count a chance for every child this deal allows, and cross its move off the untried ones
+        bool tried[MoveList::CAPACITY] = {};
+        int untried = moves.size;
+        for (int c = nodes[node].firstChild; c != -1; c = nodes[c].nextSibling)
+        {
+            int slot = moveSlots[moveKey(nodes[c].move)];
+            if (slot != -1)
+            {
+                nodes[c].availability++;
+                tried[slot] = true;
+                untried--;
+            }
+        }
+
+        int team = Rules::getTeam(game.getPlayerIndex());
+        int next = -1;
+        int slot = -1;
+        bool expanded = false;
+        if (untried > 0 && (int)nodes.size() < maxNodes)
+        {
+            // Expansion: add one of the moves this deal allows that the tree hasn't tried, then play out from it
+            int pick = (int)rng.nextBelow(untried);
+            for (int i = 0; i < moves.size && slot == -1; i++)
+            {
+                if (!tried[i] && pick-- == 0)
+                    slot = i;
+            }
+            next = addChild(node, moves[slot], team);
+            expanded = true;
+        }
+        else if (untried < moves.size)
+        {
+            // Selection: UCT over the children this deal allows, with each one's chances as its parent's visits
+            double bestScore = -1.0;
+            for (int c = nodes[node].firstChild; c != -1; c = nodes[c].nextSibling)
+            {
+                int s = moveSlots[moveKey(nodes[c].move)];
+                if (s == -1)
+                    continue;
+                // Every child is visited in the iteration that adds it
+                const Node& child = nodes[c];
+                double score = child.value / child.visits + exploration * sqrt(log((double)child.availability) / child.visits);
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    next = c;
+                    slot = s;
+                }
+            }
+        }
+
+        for (int i = 0; i < moves.size; i++)
+            moveSlots[moveKey(moves[i])] = -1;
+
+        // The pool is full and this deal allows nothing the tree knows, so play out from here
+        if (next == -1)
+            break;
+
+        // Play the tree's move from whichever hand slot holds the card in this deal
+        game.makeMove(moves[slot]);
+        node = next;
+        path[depth++] = node;
+        if (expanded)
+            break;
+    }
+
+    int winner = playOut(game, rng);
+
+    for (int i = 0; i < depth; i++)
+    {
+        Node& visited = nodes[path[i]];
+        visited.visits++;
+        visited.value += winner == -1 ? 0.5 : winner == visited.team ? 1.0 : 0.0;
+    }
+}
+
+template <class Rules>
+int ISMCTS<Rules>::addChild(int parent, const Move& move, int team)
+{
+    int child = (int)nodes.size();
+    nodes.push_back(Node{ move, (uint8_t)team, -1, nodes[parent].firstChild, 0, 1, 0.0 });
+    nodes[parent].firstChild = child;
+    return child;
+}
+
+template <class Rules>
+int ISMCTS<Rules>::moveKey(const Move& move)
+{
+    // Both jacks of a kind play the same moves, so which one a deal happens to hold mustn't split a child in two
+    int card = move.card;
+    if (board::TWO_EYED_JACKS >> card & 1)
+        card = Bitboard::lowestBit(board::TWO_EYED_JACKS);
+    else if (board::ONE_EYED_JACKS >> card & 1)
+        card = Bitboard::lowestBit(board::ONE_EYED_JACKS);
+    int cell = move.type == MoveType::EXCHANGE ? board::NUM_CELLS : move.cell;
+    return ((int)move.type * board::NUM_CARDS + card) * (board::NUM_CELLS + 1) + cell;
+}
+
+Move IsmctsAgent::chooseMove(const SequenceModel& game)
+{
+    return search.search(game.observe(game.getPlayerIndex()), limits).move;
+}
+
+template class ISMCTS<SequenceModel>;
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "Random.hpp"
+#include "Search.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Single-observer information set Monte Carlo tree search. The search only gets the observer's view of the game.
+// Each iteration deals the hidden cards out afresh with Rules::determinize and walks one shared tree with that
+// deal, so the tree's statistics average over every hand and deck order the observer can't rule out.
+// A move that is legal in one deal may not be in the next, so children are keyed by card, cell and move type
+// rather than by hand slot, and UCT counts a child's chances only in the iterations where it could be played.
+template <class Rules>
+class ISMCTS
+{
+public:
+	using Observation = typename Rules::Observation;
+	using Position = Observation;
+
+	explicit ISMCTS(uint64_t seed, double exploration = 0.7, int maxNodes = 1 << 20);
+
+	// Searches for the observer, who must be the player to move
+	SearchResult search(const Observation& observation, const SearchLimits& limits);
+	// The statistics of every root move from the last search
+	void getRootMoves(RootMoves& rootMoves) const;
+
+private:
+	struct Node
+	{
+		// The move that reaches this node. Its hand slot only means anything at the root, where the observer's
+		// hand is the same in every deal.
+		Move move;
+		// The team that played move; value is from their point of view
+		uint8_t team;
+		// Children are added one at a time, so they're kept as a list
+		int firstChild;
+		int nextSibling;
+		int visits;
+		// Iterations in which this node's move was legal when its parent was reached
+		int availability;
+		double value;
+	};
+
+	// Every distinct (type, card, cell), with exchanges on a cell of their own
+	static const int NUM_KEYS = 3 * board::NUM_CARDS * (board::NUM_CELLS + 1);
+
+	vector<Node> nodes;
+	int maxNodes;
+	double exploration;
+	Random rng;
+
+	// For each key, where that move is in the current move list, or -1. Filled and emptied at each step.
+	vector<int16_t> moveSlots;
+
+	void iterate(const Observation& observation);
+	int addChild(int parent, const Move& move, int team);
+
+	static int moveKey(const Move& move);
+};
+
+extern template class ISMCTS<SequenceModel>;
+
+// Plays the move an ISMCTS search from its own player's point of view recommends, so it never peeks at
+// the other hands or the deck
+class IsmctsAgent : public Agent
+{
+public:
+	IsmctsAgent(uint64_t seed, const SearchLimits& limits) : search(seed), limits(limits) { }
+
+	Move chooseMove(const SequenceModel& game) override;
+
+private:
+	ISMCTS<SequenceModel> search;
+	SearchLimits limits;
+};
@@ -0,0 +1,143 @@
+#include "MCTS.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+template <class Rules>
+MCTS<Rules>::MCTS(uint64_t seed, double exploration, int maxNodes) : maxNodes(maxNodes), exploration(exploration), rng(seed)
+{
+    if (maxNodes < 1)
+        throw invalid_argument("MCTS needs room for at least the root node");
+    nodes.reserve(maxNodes);
+}
+
+template <class Rules>
+SearchResult MCTS<Rules>::search(const Rules& game, const SearchLimits& limits)
+{
+    if (limits.iterations <= 0 && limits.seconds <= 0.0)
+        throw invalid_argument("search needs an iteration or time limit");
+    if (!game.hasLegalMove() || game.gameIsWon() != -1)
+        throw invalid_argument("search needs a game with a legal move to play");
+
+    nodes.clear();
+    nodes.push_back(Node{ Move(), 0, -1, 0, 0, 0.0 });
+    expand(0, game);
+
+    SearchClock clock(limits);
+    long long iterations = 0;
+    while (limits.iterations <= 0 || iterations < limits.iterations)
+    {
+        iterate(game);
+        iterations++;
+        if (clock.expired(iterations))
+            break;
+    }
+    double elapsed = clock.elapsed();
+
+    // The most visited move is the one the search trusts most
+    const Node& root = nodes[0];
+    int best = root.firstChild;
+    for (int c = root.firstChild; c < root.firstChild + root.childCount; c++)
+    {
+        if (nodes[c].visits > nodes[best].visits)
+            best = c;
+    }
+
+    if (root.childCount == 0)
+        return unsearchedResult(game, iterations, elapsed, (int)nodes.size());
+    const Node& chosen = nodes[best];
+    return SearchResult{ chosen.move, iterations, elapsed, (int)nodes.size(), chosen.visits,
+        chosen.visits > 0 ? chosen.value / chosen.visits : 0.0 };
+}
+
+template <class Rules>
+void MCTS<Rules>::getRootMoves(RootMoves& rootMoves) const
+{
+    rootMoves.size = 0;
+    for (int c = nodes[0].firstChild; c < nodes[0].firstChild + nodes[0].childCount; c++)
+        rootMoves.moves[rootMoves.size++] = RootMove{ nodes[c].move, nodes[c].visits, nodes[c].value };
+}
+
+template <class Rules>
+void MCTS<Rules>::iterate(const Rules& root)
+{
+    // Every move in a game uses up a card, so no path is longer than the deck
+    int path[constants::DECK_SIZE + 2];
+    int depth = 0;
+    path[depth++] = 0;
+
+    Rules game = root;
+    int node = 0;
+
+    // Selection: follow UCT down to a node that hasn't been expanded, or has no moves
+    while (nodes[node].childCount > 0)
+    {
+        node = selectChild(node);
+        game.makeMove(nodes[node].move);
+        path[depth++] = node;
+    }
+
+    // Expansion: add every legal move below a leaf that's been tried before, and step into the first of them
+    if (nodes[node].firstChild == -1 && nodes[node].visits > 0 && game.gameIsWon() == -1)
+    {
+        expand(node, game);
+        if (nodes[node].childCount > 0)
+        {
+            node = nodes[node].firstChild;
+            game.makeMove(nodes[node].move);
+            path[depth++] = node;
+        }
+    }
+
+    int winner = playOut(game, rng);
+
+    // Backpropagation: each node scores the result for the team that moved into it
+    for (int i = 0; i < depth; i++)
+    {
+        Node& visited = nodes[path[i]];
+        visited.visits++;
+        visited.value += winner == -1 ? 0.5 : winner == visited.team ? 1.0 : 0.0;
+    }
+}
+
+// The child with the best upper confidence bound, taking any that hasn't been tried yet first
+template <class Rules>
+int MCTS<Rules>::selectChild(int node) const
+{
+    const Node& parent = nodes[node];
+    double logVisits = log((double)parent.visits);
+
+    int best = parent.firstChild;
+    double bestScore = -1.0;
+    for (int c = parent.firstChild; c < parent.firstChild + parent.childCount; c++)
+    {
+        const Node& child = nodes[c];
+        if (child.visits == 0)
+            return c;
+        double score = child.value / child.visits + exploration * sqrt(logVisits / child.visits);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// Gives the node a child for every legal move, unless the pool has no room for them
+template <class Rules>
+void MCTS<Rules>::expand(int node, const Rules& game)
+{
+    MoveList moves;
+    game.generateMoves(moves);
+    if ((int)nodes.size() + moves.size > maxNodes)
+        return;
+
+    uint8_t team = (uint8_t)Rules::getTeam(game.getPlayerIndex());
+    nodes[node].firstChild = (int)nodes.size();
+    nodes[node].childCount = moves.size;
+    for (const Move& move : moves)
+        nodes.push_back(Node{ move, team, -1, 0, 0, 0.0 });
+}
+
+template class MCTS<SequenceModel>;
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "Random.hpp"
+#include "Search.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Monte Carlo tree search with UCT selection and uniformly random playouts to the end of the game.
+// Each iteration copies the root game, walks down the tree playing the chosen moves, expands the leaf with
+// every legal move, plays the rest of the game out at random and credits the result back up the path.
+// The tree lives in a node pool reserved once, so searching doesn't allocate after the first search.
+// Given the true game, hands and deck order included, it sees more than a player could, so MctsAgent hands it
+// a deal drawn from an observation instead.
+template <class Rules>
+class MCTS
+{
+public:
+	// What a search starts from
+	using Position = Rules;
+	using Observation = typename Rules::Observation;
+
+	explicit MCTS(uint64_t seed, double exploration = 0.7, int maxNodes = 1 << 20);
+
+	SearchResult search(const Rules& game, const SearchLimits& limits);
+	// The statistics of every root move from the last search
+	void getRootMoves(RootMoves& rootMoves) const;
+
+private:
+	struct Node
+	{
+		Move move;
+		// The team that played move to reach this node; value is from their point of view
+		uint8_t team;
+		// Index of the first of childCount consecutive children, or -1 if the node hasn't been expanded
+		int firstChild;
+		int childCount;
+		int visits;
+		double value;
+	};
+
+	vector<Node> nodes;
+	int maxNodes;
+	double exploration;
+	Random rng;
+
+	void iterate(const Rules& root);
+	int selectChild(int node) const;
+	void expand(int node, const Rules& game);
+};
+
+extern template class MCTS<SequenceModel>;
+
+// Plays the move an MCTS search recommends. MCTS needs a full game, so it searches one deal of the cards
+// its player can't see, drawn afresh for every move.
+class MctsAgent : public Agent
+{
+public:
+	MctsAgent(uint64_t seed, const SearchLimits& limits) : search(seed), limits(limits), rng(seed + 1) { }
+
+	Move chooseMove(const SequenceModel& game) override
+	{
+		return search.search(SequenceModel::determinize(game.observe(game.getPlayerIndex()), rng), limits).move;
+	}
+
+private:
+	MCTS<SequenceModel> search;
+	SearchLimits limits;
+	Random rng;
+};
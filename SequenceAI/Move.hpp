@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Bitboard.hpp"
+
+#include <cstdint>
+
+// An exchange discards a dead card for a new one and leaves the turn with the same player
+enum class MoveType : uint8_t { PLACE, REMOVE, EXCHANGE };
+
+// A single action for the player to move: play the card in a hand slot on a board cell, or exchange it
+struct Move
+{
+	MoveType type;
+	// Slot in the mover's hand holding the card that is played
+	uint8_t handIndex;
+	// Card index (suit * NUM_FACES + face) of the card that is played
+	uint8_t card;
+	// Board cell that receives the token, or loses it for a removal. Unused by exchanges.
+	uint8_t cell;
+
+	bool operator==(const Move& other) const
+	{
+		return type == other.type && handIndex == other.handIndex && card == other.card && cell == other.cell;
+	}
+	bool operator!=(const Move& other) const { return !(*this == other); }
+};
+
+// A fixed-capacity list of moves, meant to live on the stack.
+// Identical cards in a hand only produce moves once, so a position has at most 2 moves for each of
+// the 7 regular cards plus one move per open or removable cell for the jacks and one exchange per dead card,
+// which stays under 128.
+struct MoveList
+{
+	static const int CAPACITY = 128;
+
+	Move moves[CAPACITY];
+	int size = 0;
+
+	void clear() { size = 0; }
+	void add(MoveType type, int handIndex, int card, int cell)
+	{
+		moves[size++] = Move{ type, (uint8_t)handIndex, (uint8_t)card, (uint8_t)cell };
+	}
+
+	const Move& operator[](int index) const { return moves[index]; }
+	const Move* begin() const { return moves; }
+	const Move* end() const { return moves + size; }
+};
+
+// Everything makeMove changes that can't be recovered from the move itself, so unmakeMove can restore it
+struct MoveUndo
+{
+	Move move;
+	// Card index drawn into the emptied hand slot, or board::NO_CARD if the deck was empty
+	uint8_t drawn;
+	int8_t winner;
+	int8_t lastToken;
+	uint8_t lastCompleted;
+	// The team whose token a removal took off
+	uint8_t removedTeam;
+	// Whether the mover had already exchanged a card this turn
+	uint8_t exchanged;
+	// The mover's team's first sequence before the move
+	Bitboard firstSequence;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Board.hpp"
+#include "SequenceState.hpp"
+
+#include <cstdint>
+
+// What one player can see of a game: everything on the table and in their own hand.
+// The other hands keep their sizes with each card replaced by board::HIDDEN_CARD, and the deck keeps only
+// its size, so the same observation covers every deal the player can't tell apart.
+template <int SequenceLength, int Players, int HandSize, int Teams>
+struct SequenceObservation
+{
+	// The player the game is seen by
+	uint8_t player;
+
+	// The game with the hidden cards taken out, the hidden hands taken out of the hash, and the unseen counts
+	// of the other players cleared
+	SequenceState<SequenceLength, Players, HandSize, Teams> state;
+
+	// For each card index, the number of copies the player hasn't seen: in other hands or still in the deck
+	uint8_t unseen[board::NUM_CARDS];
+};
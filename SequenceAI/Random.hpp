@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+// A small, fast pseudo-random generator (xoshiro256**). Each game owns one, so games on different
+// threads never share generator state, and a game can be replayed exactly from its seed.
+class Random
+{
+public:
+	Random() { seed(0); }
+	explicit Random(uint64_t seed) { this->seed(seed); }
+
+	// Restarts the sequence. The state is filled with SplitMix64 so that nearby seeds give unrelated sequences.
+	void seed(uint64_t seed)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			s[i] = z ^ (z >> 31);
+		}
+	}
+
+	uint64_t next()
+	{
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	// A uniformly distributed integer in [0, bound), without the bias of a plain modulo
+	uint32_t nextBelow(uint32_t bound)
+	{
+		uint64_t m = (uint64_t)(uint32_t)(next() >> 32) * bound;
+		uint32_t low = (uint32_t)m;
+		if (low < bound)
+		{
+			uint32_t threshold = (0 - bound) % bound;
+			while (low < threshold)
+			{
+				m = (uint64_t)(uint32_t)(next() >> 32) * bound;
+				low = (uint32_t)m;
+			}
+		}
+		return (uint32_t)(m >> 32);
+	}
+
+	// Fisher-Yates shuffle of the range [first, last)
+	template <typename T>
+	void shuffle(T* first, T* last)
+	{
+		for (uint32_t i = (uint32_t)(last - first); i > 1; i--)
+		{
+			uint32_t j = nextBelow(i);
+			T temp = first[i - 1];
+			first[i - 1] = first[j];
+			first[j] = temp;
+		}
+	}
+
+private:
+	uint64_t s[4];
+
+	static uint64_t rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+};
@@ -0,0 +1,97 @@
+#include "RootParallel.hpp"
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+template <class Engine>
+RootParallel<Engine>::RootParallel(int threads, uint64_t seed, double exploration, int maxNodes)
+{
+    if (threads < 1)
+        throw invalid_argument("RootParallel needs at least one thread");
+
+    // Random runs each seed through SplitMix64, so consecutive seeds give unrelated generators
+    workers.reserve(threads);
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back(seed + i, seed + threads + i, exploration, maxNodes);
+}
+
+template <class Engine>
+SearchResult RootParallel<Engine>::search(const Observation& observation, const SearchLimits& limits)
+{
+    int threads = (int)workers.size();
+    auto start = chrono::steady_clock::now();
+
+    // Each thread writes only to its own worker and its own slot in errors. The calling thread does the first
+    // search itself.
+    vector<exception_ptr> errors(threads);
+    auto work = [this, &observation, &limits, &errors](int i) {
+        Worker& worker = workers[i];
+        try
+        {
+            using Position = typename Engine::Position;
+            if constexpr (is_same<Position, Observation>::value)
+                worker.result = worker.engine.search(observation, limits);
+            else
+                worker.result = worker.engine.search(Position::determinize(observation, worker.dealer), limits);
+            worker.engine.getRootMoves(worker.rootMoves);
+        }
+        catch (...)
+        {
+            errors[i] = current_exception();
+        }
+    };
+    vector<thread> helpers;
+    helpers.reserve(threads - 1);
+    for (int i = 1; i < threads; i++)
+        helpers.emplace_back(work, i);
+    work(0);
+    for (thread& helper : helpers)
+        helper.join();
+
+    // A position one search rejects, they all reject, so pass on the first complaint
+    for (const exception_ptr& error : errors)
+    {
+        if (error)
+            rethrow_exception(error);
+    }
+
+    // The observer's own moves are the same in every deal, so the searches mostly list the same root moves
+    RootMoves merged = workers[0].rootMoves;
+    for (int i = 1; i < threads; i++)
+    {
+        for (int j = 0; j < workers[i].rootMoves.size; j++)
+        {
+            const RootMove& rootMove = workers[i].rootMoves.moves[j];
+            int k = 0;
+            while (k < merged.size && merged.moves[k].move != rootMove.move)
+                k++;
+            if (k == merged.size)
+                merged.moves[merged.size++] = RootMove{ rootMove.move, 0, 0.0 };
+            merged.moves[k].visits += rootMove.visits;
+            merged.moves[k].value += rootMove.value;
+        }
+    }
+
+    SearchResult result{ workers[0].result.move, 0, chrono::duration<double>(chrono::steady_clock::now() - start).count(), 0, 0, 0.0 };
+    for (int i = 0; i < threads; i++)
+    {
+        result.iterations += workers[i].result.iterations;
+        result.nodes += workers[i].result.nodes;
+    }
+    for (int k = 0; k < merged.size; k++)
+    {
+        if (merged.moves[k].visits > result.visits)
+        {
+            result.move = merged.moves[k].move;
+            result.visits = merged.moves[k].visits;
+            result.value = merged.moves[k].value / merged.moves[k].visits;
+        }
+    }
+    return result;
+}
+
+template class RootParallel<MCTS<SequenceModel>>;
+template class RootParallel<ISMCTS<SequenceModel>>;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "ISMCTS.hpp"
+#include "MCTS.hpp"
+#include "Search.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Root parallelization: one independent search per thread, each with its own tree, generator and deals, all
+// started from the same observation. ISMCTS deals afresh every iteration; MCTS needs a full game, so each
+// thread searches one deal of its own. The threads share nothing while they search. Once they've all
+// stopped, their root visit counts and values are summed move by move and the most visited move wins.
+// Engine is MCTS<Rules> or ISMCTS<Rules>.
+template <class Engine>
+class RootParallel
+{
+public:
+	using Observation = typename Engine::Observation;
+
+	// Every thread gets a tree of up to maxNodes nodes
+	RootParallel(int threads, uint64_t seed, double exploration = 0.7, int maxNodes = 1 << 20);
+
+	// Each thread searches to the full limits, so an iteration limit is per thread
+	SearchResult search(const Observation& observation, const SearchLimits& limits);
+
+	int getThreadCount() const { return (int)workers.size(); }
+
+private:
+	// One thread's engine and what it found. A playout steps the engine's generator on every move, so each
+	// thread's state starts a cache line of its own rather than sharing one with its neighbour's.
+	struct alignas(64) Worker
+	{
+		Worker(uint64_t seed, uint64_t dealSeed, double exploration, int maxNodes) : engine(seed, exploration, maxNodes),
+			dealer(dealSeed) { }
+
+		Engine engine;
+		// Deals the observation out for engines that search a full game
+		Random dealer;
+		SearchResult result;
+		RootMoves rootMoves;
+	};
+
+	vector<Worker> workers;
+};
+
+extern template class RootParallel<MCTS<SequenceModel>>;
+extern template class RootParallel<ISMCTS<SequenceModel>>;
+
+// Plays the move a root-parallel ISMCTS search from its own player's point of view recommends
+class ParallelIsmctsAgent : public Agent
+{
+public:
+	ParallelIsmctsAgent(int threads, uint64_t seed, const SearchLimits& limits, int maxNodes = 1 << 20)
+		: search(threads, seed, 0.7, maxNodes), limits(limits) { }
+
+	Move chooseMove(const SequenceModel& game) override
+	{
+		return search.search(game.observe(game.getPlayerIndex()), limits).move;
+	}
+
+private:
+	RootParallel<ISMCTS<SequenceModel>> search;
+	SearchLimits limits;
+};
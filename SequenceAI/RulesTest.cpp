@@ -0,0 +1,193 @@
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Random.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// Plays random games of every variant and checks, after every move, that the incrementally kept parts of
+// the state match what they should be worked out from scratch, and that unmakeMove restores the state exactly.
+// Also checks that determinizing an observation gives a legal deal that agrees with everything the observer saw.
+
+static int failures = 0;
+
+static bool check(bool condition, const char* variant, uint64_t seed, int turn, const char* what)
+{
+    if (!condition)
+    {
+        printf("%s game %llu turn %d: %s\n", variant, (unsigned long long)seed, turn, what);
+        failures++;
+    }
+    return condition;
+}
+
+// Compares the counters the model keeps up to date against the tokens, hands and played cards they summarize.
+// The model doesn't keep the discard pile, so the test counts the copies of each card played itself.
+template <class Rules>
+static bool checkCounters(const Rules& game, const int* played, const char* variant, uint64_t seed, int turn)
+{
+    const auto& windows = board::WINDOWS<Rules::SEQUENCE_LENGTH>;
+    const typename Rules::State& state = game.getState();
+    bool ok = check(game.getHash() == game.computeHash(), variant, seed, turn, "hash differs from a full recompute");
+
+    for (int t = 0; t < Rules::NUM_TEAMS; t++)
+    {
+        int threats = 0;
+        for (int w = 0; w < Rules::State::NUM_WINDOWS; w++)
+        {
+            int count = ((state.tokens[t] | board::WILD_CELLS) & windows.masks[w]).count();
+            ok &= check(state.windowCounts[t][w] == count, variant, seed, turn, "window count");
+
+            bool blocked = false;
+            for (int other = 0; other < Rules::NUM_TEAMS; other++)
+                blocked |= other != t && !(state.tokens[other] & windows.masks[w]).empty();
+            threats += count == Rules::SEQUENCE_LENGTH - 1 && !blocked;
+        }
+        ok &= check(game.getThreatCount(t) == threats, variant, seed, turn, "threat count");
+    }
+
+    for (int card = 0; card < board::NUM_CARDS; card++)
+    {
+        bool jack = ((board::TWO_EYED_JACKS | board::ONE_EYED_JACKS) >> card & 1) != 0;
+        bool dead = !jack && (board::CARDS.masks[card] & ~state.occupied).empty();
+        ok &= check(game.isDeadCard(card) == dead, variant, seed, turn, "dead card");
+
+        for (int p = 0; p < Rules::NUM_PLAYERS; p++)
+        {
+            int unseen = board::COPIES_PER_CARD - played[card] - game.getCardCount(p, card);
+            ok &= check(game.getUnseenCount(p, card) == unseen, variant, seed, turn, "unseen count");
+        }
+    }
+    return ok;
+}
+
+// Checks an observation holds none of the cards its player can't see: not in the other hands, the deck,
+// the other hands' card sets or the other players' unseen counts
+template <class Rules>
+static bool checkHidden(const typename Rules::Observation& observation, const char* variant, uint64_t seed, int turn)
+{
+    const typename Rules::State& seen = observation.state;
+    bool ok = true;
+    for (int i = 0; i < constants::DECK_SIZE; i++)
+        ok &= check(seen.deck[i] == board::HIDDEN_CARD, variant, seed, turn, "observation shows a card in the deck");
+    for (int p = 0; p < Rules::NUM_PLAYERS; p++)
+    {
+        if (p == observation.player)
+            continue;
+        for (int i = 0; i < Rules::HAND_SIZE; i++)
+        {
+            ok &= check(seen.hands[p][i] == board::HIDDEN_CARD || seen.hands[p][i] == board::NO_CARD, variant, seed, turn,
+                "observation shows a card in another hand");
+        }
+        for (int k = 0; k < board::COPIES_PER_CARD; k++)
+            ok &= check(seen.handCards[p][k] == 0, variant, seed, turn, "observation shows another hand's card set");
+        for (int card = 0; card < board::NUM_CARDS; card++)
+            ok &= check(seen.unseen[p][card] == 0, variant, seed, turn, "observation shows another player's unseen counts");
+    }
+    return ok;
+}
+
+// Deals an observation of the game out again and checks the deal could be the real one
+template <class Rules>
+static bool checkDeterminize(const Rules& game, const int* played, int player, Random& rng, const char* variant, uint64_t seed,
+    int turn)
+{
+    typename Rules::Observation observation = game.observe(player);
+    if (!checkHidden<Rules>(observation, variant, seed, turn))
+        return false;
+    Rules sample = Rules::determinize(observation, rng);
+    const typename Rules::State& real = game.getState();
+    const typename Rules::State& dealt = sample.getState();
+
+    bool ok = check(sample.getHash() == sample.computeHash(), variant, seed, turn, "determinized hash");
+    ok &= check(memcmp(dealt.hands[player], real.hands[player], Rules::HAND_SIZE) == 0, variant, seed, turn,
+        "determinize changed the observer's hand");
+
+    // Every copy of every card is somewhere: in a hand, in the deck or on the discard pile
+    int copies[board::NUM_CARDS] = {};
+    for (int p = 0; p < Rules::NUM_PLAYERS; p++)
+    {
+        for (int i = 0; i < Rules::HAND_SIZE; i++)
+        {
+            ok &= check((dealt.hands[p][i] == board::NO_CARD) == (real.hands[p][i] == board::NO_CARD), variant, seed, turn,
+                "determinize filled an empty hand slot or emptied a full one");
+            if (dealt.hands[p][i] != board::NO_CARD)
+                copies[dealt.hands[p][i]]++;
+        }
+    }
+    for (int i = 0; i < dealt.deckSize; i++)
+        copies[dealt.deck[i]]++;
+    for (int card = 0; card < board::NUM_CARDS; card++)
+        ok &= check(copies[card] + played[card] == board::COPIES_PER_CARD, variant, seed, turn, "determinized deal lost or made a card");
+
+    if (game.getPlayerIndex() == player)
+    {
+        MoveList realMoves, sampleMoves;
+        game.generateMoves(realMoves);
+        sample.generateMoves(sampleMoves);
+        ok &= check(realMoves.size == sampleMoves.size, variant, seed, turn, "determinized deal changed the observer's moves");
+    }
+    return ok && checkCounters(sample, played, variant, seed, turn);
+}
+
+template <class Rules>
+static void run(const char* variant, int games)
+{
+    Random rng(1);
+    for (uint64_t seed = 1; seed <= (uint64_t)games; seed++)
+    {
+        Rules game(seed);
+        int played[board::NUM_CARDS] = {};
+        MoveList moves;
+        for (int turn = 0; game.generateMoves(moves) > 0; turn++)
+        {
+            if (!check((moves.size > 0) == game.hasLegalMove(), variant, seed, turn, "hasLegalMove disagrees with generateMoves"))
+                return;
+
+            // Every move must come back exactly, not just the one that is played
+            typename Rules::State before = game.getState();
+            for (const Move& move : moves)
+            {
+                MoveUndo undo;
+                game.makeMove(move, undo);
+                played[move.card]++;
+                bool ok = checkCounters(game, played, variant, seed, turn);
+                played[move.card]--;
+                game.unmakeMove(undo);
+                ok &= check(memcmp(&before, &game.getState(), sizeof before) == 0, variant, seed, turn,
+                    "unmakeMove didn't restore the state");
+                if (!ok)
+                    return;
+            }
+
+            const Move& move = moves[rng.nextBelow(moves.size)];
+            played[move.card]++;
+            game.makeMove(move);
+            if (!checkDeterminize(game, played, (int)rng.nextBelow(Rules::NUM_PLAYERS), rng, variant, seed, turn))
+                return;
+        }
+        check(game.gameIsOver(), variant, seed, -1, "a game with no moves isn't over");
+    }
+}
+
+int main()
+{
+    run<SequenceModel>("standard", 20);
+    run<SequenceRules<10, 4, 2, 7>>("sequences of 4", 20);
+    run<SequenceRules<10, 3, 2, 7>>("sequences of 3", 20);
+    run<ThreePlayerModel>("3 players", 20);
+    run<TwoVersusTwoModel>("2 versus 2", 20);
+    run<ThreeVersusThreeModel>("3 versus 3", 20);
+    run<ThreeTeamsOfTwoModel>("3 teams of 2", 20);
+
+    if (failures > 0)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("All rules checks passed\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Move.hpp"
+#include "Random.hpp"
+
+#include <chrono>
+
+// How long a search may run. It stops at whichever limit it reaches first, and a limit of 0 doesn't apply.
+struct SearchLimits
+{
+	long long iterations = 0;
+	double seconds = 1.0;
+};
+
+// The move a search chose, and what it took to choose it
+struct SearchResult
+{
+	Move move;
+	long long iterations;
+	double seconds;
+	// Tree nodes in use when the search stopped
+	int nodes;
+	// How often the chosen move was tried, and the average result for the player making it (1 win, 0.5 draw, 0 loss)
+	int visits;
+	double value;
+
+	double iterationsPerSecond() const { return seconds > 0.0 ? (double)iterations / seconds : 0.0; }
+};
+
+// How one search rated one of the moves at its root, for combining several searches of the same position
+struct RootMove
+{
+	Move move;
+	int visits;
+	double value;
+};
+
+struct RootMoves
+{
+	RootMove moves[MoveList::CAPACITY];
+	int size = 0;
+};
+
+// Times a search against its limits. Reading the clock costs about as much as a few tree steps, so a search
+// only asks every 64 iterations whether its time is up.
+class SearchClock
+{
+public:
+	explicit SearchClock(const SearchLimits& limits) : limits(limits), start(std::chrono::steady_clock::now()) { }
+
+	bool expired(long long iterations) const
+	{
+		return limits.seconds > 0.0 && iterations % 64 == 0 && elapsed() >= limits.seconds;
+	}
+
+	double elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+
+private:
+	SearchLimits limits;
+	std::chrono::steady_clock::time_point start;
+};
+
+// Plays uniformly random moves to the end of the game and returns the winning team, or -1 for a draw
+template <class Rules>
+int playOut(Rules& game, Random& rng)
+{
+	MoveList moves;
+	while (game.generateMoves(moves) > 0)
+		game.makeMove(moves[rng.nextBelow(moves.size)]);
+	return game.gameIsWon();
+}
+
+// What a search returns when its pool was too small for the root's children, so nothing below the root was
+// searched: the first legal move
+template <class Rules>
+SearchResult unsearchedResult(const Rules& game, long long iterations, double seconds, int nodes)
+{
+	MoveList moves;
+	game.generateMoves(moves);
+	return SearchResult{ moves[0], iterations, seconds, nodes, 0, 0.0 };
+}
@@ -0,0 +1,140 @@
+#include "ISMCTS.hpp"
+#include "MCTS.hpp"
+#include "Random.hpp"
+#include "RootParallel.hpp"
+#include "SequenceModel.hpp"
+#include "TreeParallel.hpp"
+
+#include <cstdio>
+
+using namespace std;
+
+// Runs every search engine, and every agent built on one, on positions from random games, with node pools down
+// to a single node and iteration budgets down to one iteration. Checks the move each returns is one of the
+// legal moves, and that the search ran exactly its iteration budget and kept to its pool.
+
+static int failures = 0;
+
+static bool check(bool condition, const char* engine, uint64_t seed, int turn, const char* what)
+{
+    if (!condition)
+    {
+        printf("%s game %llu turn %d: %s\n", engine, (unsigned long long)seed, turn, what);
+        failures++;
+    }
+    return condition;
+}
+
+static bool isLegal(const SequenceModel& game, const Move& move)
+{
+    MoveList moves;
+    game.generateMoves(moves);
+    for (const Move& legal : moves)
+    {
+        if (legal == move)
+            return true;
+    }
+    return false;
+}
+
+static void checkResult(const SearchResult& result, const SequenceModel& game, long long iterations, int maxNodes,
+    const char* engine, uint64_t seed, int turn)
+{
+    check(isLegal(game, result.move), engine, seed, turn, "search chose an illegal move");
+    check(result.iterations == iterations, engine, seed, turn, "search didn't run its iteration budget exactly");
+    check(result.nodes >= 1 && result.nodes <= maxNodes, engine, seed, turn, "search used more nodes than its pool holds");
+}
+
+// Searches the position with every engine, for each pool size and iteration budget
+static void checkPosition(const SequenceModel& game, uint64_t seed, int turn)
+{
+    const int threads = 3;
+    const int poolSizes[] = { 1, 8, 1 << 12 };
+    const long long budgets[] = { 1, 40 };
+    SequenceModel::Observation observation = game.observe(game.getPlayerIndex());
+
+    for (int maxNodes : poolSizes)
+    {
+        MCTS<SequenceModel> mcts(seed, 0.7, maxNodes);
+        ISMCTS<SequenceModel> ismcts(seed, 0.7, maxNodes);
+        RootParallel<MCTS<SequenceModel>> rootMcts(threads, seed, 0.7, maxNodes);
+        RootParallel<ISMCTS<SequenceModel>> rootIsmcts(threads, seed, 0.7, maxNodes);
+        TreeParallelMCTS<SequenceModel> treeMcts(threads, seed, 0.7, maxNodes);
+
+        for (long long budget : budgets)
+        {
+            SearchLimits limits{ budget, 0.0 };
+            checkResult(mcts.search(game, limits), game, budget, maxNodes, "MCTS", seed, turn);
+            checkResult(ismcts.search(observation, limits), game, budget, maxNodes, "ISMCTS", seed, turn);
+            checkResult(rootMcts.search(observation, limits), game, threads * budget, threads * maxNodes, "root-parallel MCTS",
+                seed, turn);
+            checkResult(rootIsmcts.search(observation, limits), game, threads * budget, threads * maxNodes,
+                "root-parallel ISMCTS", seed, turn);
+            checkResult(treeMcts.search(game, limits), game, budget, maxNodes, "tree-parallel MCTS", seed, turn);
+        }
+    }
+}
+
+// Runs each agent through a whole game on small budgets, checking every move it plays
+static void checkAgents(uint64_t seed)
+{
+    SearchLimits limits{ 20, 0.0 };
+    MctsAgent mcts(seed, limits);
+    IsmctsAgent ismcts(seed, limits);
+    ParallelIsmctsAgent rootIsmcts(2, seed, limits, 1 << 12);
+    ParallelMctsAgent rootMcts(Parallelism::ROOT, 2, seed, limits);
+    ParallelMctsAgent treeMcts(Parallelism::TREE, 2, seed, limits);
+    RandomAgent random(seed);
+    Agent* agents[] = { &mcts, &ismcts, &rootIsmcts, &rootMcts, &treeMcts, &random };
+    const char* names[] = { "MctsAgent", "IsmctsAgent", "ParallelIsmctsAgent", "root ParallelMctsAgent",
+        "tree ParallelMctsAgent", "RandomAgent" };
+
+    SequenceModel game(seed);
+    for (int turn = 0; game.hasLegalMove() && game.gameIsWon() == -1; turn++)
+    {
+        int a = turn % 6;
+        Move move = agents[a]->chooseMove(game);
+        if (!check(isLegal(game, move), names[a], seed, turn, "agent chose an illegal move"))
+            return;
+        game.makeMove(move);
+    }
+}
+
+int main()
+{
+    // Positions from the opening, the middle and late in random games
+    const int turns[] = { 0, 25, 60 };
+    for (uint64_t seed = 1; seed <= 4; seed++)
+    {
+        Random rng(seed);
+        SequenceModel game(seed);
+        MoveList moves;
+        for (int turn = 0; turn <= turns[2] && game.generateMoves(moves) > 0 && game.gameIsWon() == -1; turn++)
+        {
+            if (turn == turns[0] || turn == turns[1] || turn == turns[2])
+                checkPosition(game, seed, turn);
+            game.makeMove(moves[rng.nextBelow(moves.size)]);
+        }
+    }
+
+    // A time limit stops the search, within a generous allowance for a busy machine
+    SequenceModel game(1);
+    SearchLimits limits{ 0, 0.05 };
+    MCTS<SequenceModel> mcts(1);
+    SearchResult result = mcts.search(game, limits);
+    check(result.seconds >= 0.05 && result.seconds < 1.0, "MCTS", 1, 0, "search didn't stop at its time limit");
+    TreeParallelMCTS<SequenceModel> treeMcts(2, 1);
+    result = treeMcts.search(game, limits);
+    check(result.seconds >= 0.05 && result.seconds < 1.0, "tree-parallel MCTS", 1, 0, "search didn't stop at its time limit");
+
+    for (uint64_t seed = 1; seed <= 2; seed++)
+        checkAgents(seed);
+
+    if (failures > 0)
+    {
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("All search checks passed\n");
+    return 0;
+}
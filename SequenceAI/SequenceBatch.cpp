@@ -0,0 +1,351 @@
+#include "SequenceBatch.hpp"
+
+#include <algorithm>
+
+template <class Rules>
+SequenceBatch<Rules>::SequenceBatch(int size, uint64_t seed) : games(size),
+    tokensLo(NUM_TEAMS * size), tokensHi(NUM_TEAMS * size), firstLo(NUM_TEAMS * size), firstHi(NUM_TEAMS * size),
+    occupiedLo(size), occupiedHi(size), deadCards(size),
+    openLo(size), openHi(size), removableLo(size), removableHi(size), openCounts(size), removableCounts(size),
+    hands(NUM_PLAYERS * HAND_SIZE * size), decks(constants::DECK_SIZE * size), deckSizes(size),
+    toMove(size), exchanged(size), winners(size), finished(size)
+{
+    reset(seed);
+}
+
+// Starts every game again, shuffling the deck of game g exactly as a single game seeded with seed + g would
+template <class Rules>
+void SequenceBatch<Rules>::reset(uint64_t seed)
+{
+    for (int i = 0; i < NUM_TEAMS * games; i++)
+    {
+        tokensLo[i] = tokensHi[i] = 0;
+        firstLo[i] = firstHi[i] = 0;
+    }
+    for (int g = 0; g < games; g++)
+    {
+        occupiedLo[g] = occupiedHi[g] = 0;
+        deadCards[g] = 0;
+        toMove[g] = constants::P1;
+        exchanged[g] = 0;
+        winners[g] = -1;
+        finished[g] = 0;
+    }
+
+    Random rng;
+    for (int g = 0; g < games; g++)
+    {
+        uint8_t* deck = &decks[g * constants::DECK_SIZE];
+        for (int i = 0; i < constants::DECK_SIZE; i++)
+            deck[i] = (uint8_t)(i % board::NUM_CARDS);
+        rng.seed(seed + g);
+        rng.shuffle(deck, deck + constants::DECK_SIZE);
+        deckSizes[g] = constants::DECK_SIZE;
+
+        for (int p = 0; p < NUM_PLAYERS; p++)
+        {
+            for (int i = 0; i < HAND_SIZE; i++)
+                hands[(g * NUM_PLAYERS + p) * HAND_SIZE + i] = drawCard(g);
+        }
+    }
+}
+
+// One word of the open cells of every game
+static void openColumn(uint64_t* open, const uint64_t* occupied, uint64_t cells, int games)
+{
+    for (int g = 0; g < games; g++)
+        open[g] = ~occupied[g] & cells;
+}
+
+// Adds one word of a team's removable tokens to every game whose player to move is on another team,
+// selecting with a mask rather than a branch
+template <int Teams>
+static void addRemovableColumn(uint64_t* removable, const uint64_t* tokens, const uint64_t* first, const uint8_t* toMove, int team, int games)
+{
+    for (int g = 0; g < games; g++)
+    {
+        uint64_t opposing = 0 - (uint64_t)(toMove[g] % Teams != team);
+        removable[g] |= tokens[g] & ~first[g] & opposing;
+    }
+}
+
+// Counts the cells in each game's set, with shifts and adds rather than a popcount instruction, which the build
+// can't assume, so the loop vectorizes
+static void countColumn(uint8_t* counts, const uint64_t* lo, const uint64_t* hi, int games)
+{
+    for (int g = 0; g < games; g++)
+    {
+        uint64_t l = lo[g] - ((lo[g] >> 1) & 0x5555555555555555ull);
+        uint64_t h = hi[g] - ((hi[g] >> 1) & 0x5555555555555555ull);
+        l = (l & 0x3333333333333333ull) + ((l >> 2) & 0x3333333333333333ull);
+        h = (h & 0x3333333333333333ull) + ((h >> 2) & 0x3333333333333333ull);
+        uint64_t x = ((l + (l >> 4)) & 0x0f0f0f0f0f0f0f0full) + ((h + (h >> 4)) & 0x0f0f0f0f0f0f0f0full);
+        x += x >> 8;
+        x += x >> 16;
+        x += x >> 32;
+        counts[g] = (uint8_t)(x & 0xff);
+    }
+}
+
+// Works out the open and removable cells of every game in passes over whole columns. Each pass reads and
+// writes only a few columns, so the compiler can check they don't overlap and vectorize it.
+template <class Rules>
+void SequenceBatch<Rules>::updateMasks()
+{
+    openColumn(openLo.data(), occupiedLo.data(), ~board::WILD_CELLS.lo & board::ALL_CELLS.lo, games);
+    openColumn(openHi.data(), occupiedHi.data(), ~board::WILD_CELLS.hi & board::ALL_CELLS.hi, games);
+
+    fill(removableLo.begin(), removableLo.end(), 0);
+    fill(removableHi.begin(), removableHi.end(), 0);
+    for (int t = 0; t < NUM_TEAMS; t++)
+    {
+        addRemovableColumn<NUM_TEAMS>(removableLo.data(), &tokensLo[t * games], &firstLo[t * games], toMove.data(), t, games);
+        addRemovableColumn<NUM_TEAMS>(removableHi.data(), &tokensHi[t * games], &firstHi[t * games], toMove.data(), t, games);
+    }
+    countColumn(openCounts.data(), openLo.data(), openHi.data(), games);
+    countColumn(removableCounts.data(), removableLo.data(), removableHi.data(), games);
+}
+
+template <class Rules>
+int SequenceBatch<Rules>::advance(Random& rng)
+{
+    updateMasks();
+
+    int running = 0;
+    for (int g = 0; g < games; g++)
+    {
+        if (finished[g])
+            continue;
+        Bitboard open(openLo[g], openHi[g]);
+        Bitboard removable(removableLo[g], removableHi[g]);
+        uint64_t held = getHeldCards(g);
+        int count = countMoves(g, held, open);
+
+        // A player with nothing to do ends the game as a draw
+        if (count == 0)
+        {
+            finished[g] = 1;
+            continue;
+        }
+        makeMove(g, findMove(g, held, open, removable, (int)rng.nextBelow(count)));
+        running += !finished[g];
+    }
+    return running;
+}
+
+// The cards (one bit per card index) in the hand of the player to move
+template <class Rules>
+uint64_t SequenceBatch<Rules>::getHeldCards(int game) const
+{
+    const uint8_t* hand = &hands[(game * NUM_PLAYERS + toMove[game]) * HAND_SIZE];
+    uint64_t held = 0;
+    for (int i = 0; i < HAND_SIZE; i++)
+    {
+        if (hand[i] != board::NO_CARD)
+            held |= 1ull << hand[i];
+    }
+    return held;
+}
+
+// The number of cells in a set of at most two, such as a regular card's cells, without a popcount
+static int countPair(Bitboard cells)
+{
+    return (cells.lo != 0) + ((cells.lo & (cells.lo - 1)) != 0) + (cells.hi != 0) + ((cells.hi & (cells.hi - 1)) != 0);
+}
+
+// The number of moves Rules::listMoves would list, counted a card at a time. The jacks' moves were counted
+// along with the masks.
+template <class Rules>
+int SequenceBatch<Rules>::countMoves(int game, uint64_t held, Bitboard open) const
+{
+    if (winners[game] != -1)
+        return 0;
+
+    int count = 0;
+    if (held & board::TWO_EYED_JACKS)
+        count += openCounts[game];
+    if (held & board::ONE_EYED_JACKS)
+        count += removableCounts[game];
+
+    held &= ~(board::TWO_EYED_JACKS | board::ONE_EYED_JACKS);
+    uint64_t live = held & ~deadCards[game];
+    while (live)
+    {
+        count += countPair(board::CARDS.masks[Bitboard::lowestBit(live)] & open);
+        live &= live - 1;
+    }
+    if (!exchanged[game] && deckSizes[game] > 0)
+    {
+        for (uint64_t dead = held & deadCards[game]; dead; dead &= dead - 1)
+            count++;
+    }
+    return count;
+}
+
+// The move at the index in the list Rules::listMoves would make, found by skipping whole cards' moves at a time
+template <class Rules>
+Move SequenceBatch<Rules>::findMove(int game, uint64_t held, Bitboard open, Bitboard removable, int index) const
+{
+    const uint8_t* hand = &hands[(game * NUM_PLAYERS + toMove[game]) * HAND_SIZE];
+    auto pick = [hand](MoveType type, int card, Bitboard cells, int count, int& index, Move& move) {
+        if (index >= count)
+        {
+            index -= count;
+            return false;
+        }
+        move = Move{ type, (uint8_t)Rules::findInHand(hand, card), (uint8_t)card, (uint8_t)cells.nth(index) };
+        return true;
+    };
+
+    Move move;
+    uint64_t twoEyed = held & board::TWO_EYED_JACKS;
+    if (twoEyed && pick(MoveType::PLACE, Bitboard::lowestBit(twoEyed), open, openCounts[game], index, move))
+        return move;
+    uint64_t oneEyed = held & board::ONE_EYED_JACKS;
+    if (oneEyed && pick(MoveType::REMOVE, Bitboard::lowestBit(oneEyed), removable, removableCounts[game], index, move))
+        return move;
+
+    held &= ~(board::TWO_EYED_JACKS | board::ONE_EYED_JACKS);
+    uint64_t live = held & ~deadCards[game];
+    while (live)
+    {
+        int card = Bitboard::lowestBit(live);
+        live &= live - 1;
+        Bitboard cells = board::CARDS.masks[card] & open;
+        if (pick(MoveType::PLACE, card, cells, countPair(cells), index, move))
+            return move;
+    }
+
+    // What's left is an exchange of the index-th dead card held
+    uint64_t dead = held & deadCards[game];
+    for (; index > 0; index--)
+        dead &= dead - 1;
+    int card = Bitboard::lowestBit(dead);
+    return Move{ MoveType::EXCHANGE, (uint8_t)Rules::findInHand(hand, card), (uint8_t)card, board::NO_CARD };
+}
+
+// Fills the list with every legal move in the game, in the same order as Rules::generateMoves
+template <class Rules>
+int SequenceBatch<Rules>::generateMoves(int game, MoveList& moves) const
+{
+    int team = Rules::getTeam(toMove[game]);
+    Bitboard open = ~(Bitboard(occupiedLo[game], occupiedHi[game]) | board::WILD_CELLS) & board::ALL_CELLS;
+    Bitboard removable;
+    for (int t = 0; t < NUM_TEAMS; t++)
+    {
+        if (t != team)
+            removable |= getTokens(game, t) & ~getFirstSequence(game, t);
+    }
+    return generateMoves(game, open, removable, moves);
+}
+
+// Lists the moves with the same code as Rules::generateMoves, from the game's columns instead of a State
+template <class Rules>
+int SequenceBatch<Rules>::generateMoves(int game, Bitboard open, Bitboard removable, MoveList& moves) const
+{
+    moves.clear();
+    if (winners[game] != -1)
+        return 0;
+
+    const uint8_t* hand = &hands[(game * NUM_PLAYERS + toMove[game]) * HAND_SIZE];
+    return Rules::listMoves(hand, getHeldCards(game), open, removable, deadCards[game], !exchanged[game] && deckSizes[game] > 0,
+        moves);
+}
+
+template <class Rules>
+uint8_t SequenceBatch<Rules>::drawCard(int game)
+{
+    if (deckSizes[game] == 0)
+        return board::NO_CARD;
+    return decks[game * constants::DECK_SIZE + --deckSizes[game]];
+}
+
+// Plays a legal move in one game, with the same effect on it as Rules::makeMove
+template <class Rules>
+void SequenceBatch<Rules>::makeMove(int game, const Move& move)
+{
+    int player = toMove[game];
+    int team = Rules::getTeam(player);
+
+    if (move.type == MoveType::REMOVE)
+    {
+        for (int t = 0; t < NUM_TEAMS; t++)
+        {
+            if (getTokens(game, t).test(move.cell))
+            {
+                removeToken(game, t, move.cell);
+                break;
+            }
+        }
+    }
+    else if (move.type == MoveType::PLACE)
+    {
+        placeToken(game, team, move.cell);
+        scoreSequences(game, team, move.cell);
+    }
+
+    hands[(game * NUM_PLAYERS + player) * HAND_SIZE + move.handIndex] = drawCard(game);
+
+    // An exchange keeps the turn, while anything else passes it on
+    if (move.type == MoveType::EXCHANGE)
+    {
+        exchanged[game] = 1;
+        return;
+    }
+    exchanged[game] = 0;
+    toMove[game] = (uint8_t)((player + 1) % NUM_PLAYERS);
+    if (winners[game] != -1)
+        finished[game] = 1;
+}
+
+template <class Rules>
+void SequenceBatch<Rules>::placeToken(int game, int team, int index)
+{
+    Bitboard cell = Bitboard::cell(index);
+    tokensLo[team * games + game] |= cell.lo;
+    tokensHi[team * games + game] |= cell.hi;
+    occupiedLo[game] |= cell.lo;
+    occupiedHi[game] |= cell.hi;
+    deadCards[game] = Rules::deadCardsAfterPlacing(deadCards[game], Bitboard(occupiedLo[game], occupiedHi[game]), index);
+}
+
+template <class Rules>
+void SequenceBatch<Rules>::removeToken(int game, int team, int index)
+{
+    Bitboard cell = Bitboard::cell(index);
+    tokensLo[team * games + game] &= ~cell.lo;
+    tokensHi[team * games + game] &= ~cell.hi;
+    occupiedLo[game] &= ~cell.lo;
+    occupiedHi[game] &= ~cell.hi;
+    deadCards[game] = Rules::deadCardsAfterRemoving(deadCards[game], index);
+}
+
+// Rules::scoreSequences, finding complete windows from the token masks since the batch keeps no window counts
+template <class Rules>
+void SequenceBatch<Rules>::scoreSequences(int game, int team, int placed)
+{
+    const auto& windows = board::WINDOWS<Rules::SEQUENCE_LENGTH>;
+    Bitboard covered = getTokens(game, team) | board::WILD_CELLS;
+    Bitboard first = getFirstSequence(game, team);
+
+    for (int i = 0; i < windows.cellWindowCount[placed]; i++)
+    {
+        Bitboard window = windows.masks[windows.cellWindows[placed][i]];
+        if ((covered & window) != window)
+            continue;
+
+        if (!Rules::scoresSequence(window, first))
+            continue;
+
+        if (Rules::winsWithSequence(first))
+            winners[game] = (int8_t)team;
+        if (first.empty())
+        {
+            firstLo[team * games + game] = window.lo;
+            firstHi[team * games + game] = window.hi;
+        }
+        return;
+    }
+}
+
+template class SequenceBatch<SequenceModel>;
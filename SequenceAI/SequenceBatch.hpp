@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Bitboard.hpp"
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "Random.hpp"
+#include "SequenceModel.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Many games of the same rules variant played side by side, for bulk simulation.
+// The board fields are each stored as one array across all the games (structure of arrays), so the passes that
+// touch one field of every game run over contiguous memory and compile to SIMD loops. Hands and decks are read a
+// game at a time, so they stay together per game. Moves are listed and scored by the static rules Rules shares,
+// and a random advance doesn't list them at all: it counts each game's moves from the masks and their cell
+// counts, which are worked out for every game in a pass, and builds only the move it picks.
+// Game g plays out exactly as Rules(seed + g) would given the same choice of moves, apart from the threat counts
+// and hashes, which the batch doesn't keep.
+template <class Rules>
+class SequenceBatch
+{
+public:
+	static const int NUM_PLAYERS = Rules::NUM_PLAYERS;
+	static const int NUM_TEAMS = Rules::NUM_TEAMS;
+	static const int HAND_SIZE = Rules::HAND_SIZE;
+
+	SequenceBatch(int size, uint64_t seed);
+
+	void reset(uint64_t seed);
+	int size() const { return games; }
+
+	// Plays one random legal move in every unfinished game, and returns how many games are still going.
+	// The moves are counted a card at a time and only the chosen one is built, so no game lists its moves, but
+	// the games play exactly as advance(policy) would with a policy drawing rng.nextBelow(moves.size).
+	int advance(Random& rng);
+
+	// Plays the move chosen by policy(game, moves), which returns an index into moves, in every unfinished game.
+	// Returns how many games are still going.
+	template <class Policy>
+	int advance(Policy&& policy)
+	{
+		updateMasks();
+
+		int running = 0;
+		MoveList moves;
+		for (int g = 0; g < games; g++)
+		{
+			if (finished[g])
+				continue;
+			generateMoves(g, Bitboard(openLo[g], openHi[g]), Bitboard(removableLo[g], removableHi[g]), moves);
+
+			// A player with nothing to do ends the game as a draw
+			if (moves.size == 0)
+			{
+				finished[g] = 1;
+				continue;
+			}
+			makeMove(g, moves[policy(g, moves)]);
+			running += !finished[g];
+		}
+		return running;
+	}
+
+	int generateMoves(int game, MoveList& moves) const;
+	void makeMove(int game, const Move& move);
+
+	bool isFinished(int game) const { return finished[game] != 0; }
+	int getWinner(int game) const { return winners[game]; }
+	int getPlayerIndex(int game) const { return toMove[game]; }
+	int getDeckSize(int game) const { return deckSizes[game]; }
+	uint8_t getHandCard(int game, int player, int index) const { return hands[(game * NUM_PLAYERS + player) * HAND_SIZE + index]; }
+	Bitboard getTokens(int game, int team) const { return Bitboard(tokensLo[team * games + game], tokensHi[team * games + game]); }
+	Bitboard getFirstSequence(int game, int team) const { return Bitboard(firstLo[team * games + game], firstHi[team * games + game]); }
+
+private:
+	int games;
+
+	// Cells covered by each team's tokens, and by their first sequence, indexed [team * games + game]
+	vector<uint64_t> tokensLo, tokensHi;
+	vector<uint64_t> firstLo, firstHi;
+	vector<uint64_t> occupiedLo, occupiedHi;
+	vector<uint64_t> deadCards;
+
+	// Open and removable cells for the player to move in each game, and how many of each, refreshed at the start
+	// of each advance
+	vector<uint64_t> openLo, openHi;
+	vector<uint64_t> removableLo, removableHi;
+	vector<uint8_t> openCounts, removableCounts;
+
+	// Each game's hands in one block, indexed [(game * NUM_PLAYERS + player) * HAND_SIZE + slot], so reading a hand
+	// touches one cache line. Each game's deck is in one block too.
+	vector<uint8_t> hands;
+	vector<uint8_t> decks;
+	vector<uint8_t> deckSizes;
+
+	vector<uint8_t> toMove;
+	vector<uint8_t> exchanged;
+	vector<int8_t> winners;
+	vector<uint8_t> finished;
+
+	void updateMasks();
+	int generateMoves(int game, Bitboard open, Bitboard removable, MoveList& moves) const;
+	uint64_t getHeldCards(int game) const;
+	int countMoves(int game, uint64_t held, Bitboard open) const;
+	Move findMove(int game, uint64_t held, Bitboard open, Bitboard removable, int index) const;
+	uint8_t drawCard(int game);
+	void placeToken(int game, int team, int index);
+	void removeToken(int game, int team, int index);
+	void scoreSequences(int game, int team, int index);
+};
+
+extern template class SequenceBatch<SequenceModel>;
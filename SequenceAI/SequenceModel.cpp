@@ -2,257 +2,914 @@
 #include <iostream>
 #include <algorithm>
 #include <ctime>
-#include <cstdlib>
+#include <random>
+#include <stdexcept>
 #include <string>
-#include <functional>
 
-SequenceModel::SequenceModel()
+// Starts a game with a fresh, unpredictable seed
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::SequenceRules() : SequenceRules(((uint64_t)random_device()() << 32) ^ (uint64_t)time(0))
 {
-    srand(time(0));
-    reset();
+
 }
 
-void SequenceModel::reset()
+// Starts a game whose deck order is fully determined by the seed
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::SequenceRules(uint64_t seed)
 {
-    state = GameState::TURN_P1;
-    winner = -1;
+    reset(seed);
+}
 
-    deck.clear();
+// Continues the game from a copy of another game's state
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::SequenceRules(const State& state) : state(state), seed(0)
+{
+
+}
+
+// Starts a new game, shuffling the deck with a generator started from the given seed
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::reset(uint64_t seed)
+{
+    this->seed = seed;
+
+    state.toMove = constants::P1;
+    state.exchanged = 0;
+    state.winner = -1;
+    state.lastToken = -1;
+    state.lastCompleted = 0;
+
+    state.occupied = Bitboard();
+    state.deadCards = 0;
+    for (int t = 0; t < Teams; t++)
+    {
+        state.tokens[t] = Bitboard();
+        state.firstSequence[t] = Bitboard();
+
+        // Only the wild corners cover any cells at the start of the game
+        for (int w = 0; w < State::NUM_WINDOWS; w++)
+            state.windowCounts[t][w] = windows.wildCount[w];
+    }
+    for (int t = 0; t < Teams; t++)
+    {
+        state.threats[t] = 0;
+        for (int w = 0; w < State::NUM_WINDOWS; w++)
+            state.threats[t] += isThreat(t, w);
+    }
 
     // Initialize deck
     for (int i = 0; i < constants::DECK_SIZE; i++)
     {
         // cheat mode (all wilds)
-        //deck.push_back(Card(3, 10));
-        deck.push_back(Card((i % 52) / constants::NUM_FACES, (i % 52) % constants::NUM_FACES));
+        //state.deck[i] = constants::SUIT_DIAMOND + constants::FACE_JACK;
+        state.deck[i] = (uint8_t)(i % board::NUM_CARDS);
     }
+    state.deckSize = constants::DECK_SIZE;
     // Shuffle deck
-    random_shuffle(deck.begin(), deck.end());
+    Random rng(seed);
+    rng.shuffle(state.deck, state.deck + constants::DECK_SIZE);
 
-    for (int p = 0; p < constants::NUM_PLAYERS; p++)
+    for (int p = 0; p < Players; p++)
     {
-        for (int i = 0; i < constants::HAND_SIZE; i++)
+        for (int i = 0; i < HandSize; i++)
+            state.hands[p][i] = board::NO_CARD;
+        for (int k = 0; k < board::COPIES_PER_CARD; k++)
+            state.handCards[p][k] = 0;
+        for (int card = 0; card < board::NUM_CARDS; card++)
+            state.unseen[p][card] = board::COPIES_PER_CARD;
+    }
+
+    state.hash = computeHash();
+
+    // Deal the hands
+    for (int p = 0; p < Players; p++)
+    {
+        for (int i = 0; i < HandSize; i++)
         {
-            hands[p][i] = drawCard();
+            setHandCard(p, i, drawCard(p));
         }
     }
+}
 
-    for (int p = 0; p < constants::NUM_PLAYERS; p++)
+// Hashes the whole position from scratch
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::computeHash() const
+{
+    uint64_t h = keys.sideToMove[state.toMove];
+    if (state.exchanged)
+        h ^= keys.exchanged;
+    for (int t = 0; t < Teams; t++)
+    {
+        h ^= zobrist::cells(keys.tokens[t], state.tokens[t]);
+        h ^= zobrist::cells(keys.firstSequence[t], state.firstSequence[t]);
+    }
+    for (int p = 0; p < Players; p++)
     {
-        for (int i = 0; i < constants::SEQUENCE_LENGTH; i++)
+        int copies[board::NUM_CARDS] = {};
+        for (int i = 0; i < HandSize; i++)
         {
-            firstSequence[p][i] = -1;
+            int card = state.hands[p][i];
+            if (card != board::NO_CARD)
+                h ^= keys.hands[p][card][copies[card]++];
         }
     }
+    return h;
+}
+
+// Puts a card in a hand slot, updating the hand's card sets and the hash for the card it replaces and the new one
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::setHandCard(int player, int index, uint8_t card)
+{
+    uint64_t* held = state.handCards[player];
+
+    // Each copy of a card has its own key, chosen by how many copies the rest of the hand holds
+    uint8_t old = state.hands[player][index];
+    if (old != board::NO_CARD)
+    {
+        int copy = held[1] >> old & 1;
+        held[copy] &= ~(1ull << old);
+        state.hash ^= keys.hands[player][old][copy];
+    }
+    if (card != board::NO_CARD)
+    {
+        int copy = held[0] >> card & 1;
+        held[copy] |= 1ull << card;
+        state.hash ^= keys.hands[player][card][copy];
+    }
+
+    state.hands[player][index] = card;
 }
 
-Card SequenceModel::drawCard()
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::setFirstSequence(int team, Bitboard cells)
 {
-    if (deck.size() == 0)
-        return Card::invalid;
-    Card card = Card(deck.back());
-    deck.pop_back();
+    state.hash ^= zobrist::cells(keys.firstSequence[team], state.firstSequence[team] ^ cells);
+    state.firstSequence[team] = cells;
+}
+
+// Takes the top card of the deck for the player, who has now seen it
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint8_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::drawCard(int player)
+{
+    if (state.deckSize == 0)
+        return board::NO_CARD;
+    uint8_t card = state.deck[--state.deckSize];
+    state.unseen[player][card]--;
     return card;
 }
 
-int SequenceModel::clickCard(int x, int y, Card* usedCard)
+// Puts a card the player played face up on the discard pile, where everyone else sees it too
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::discardCard(int player, uint8_t card)
+{
+    for (int p = 0; p < Players; p++)
+    {
+        if (p != player)
+            state.unseen[p][card]--;
+    }
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::placeToken(int team, int index)
 {
-    int index = y * constants::GAME_BOARD_SIZE + x;
+    state.tokens[team].set(index);
+    state.occupied.set(index);
+    state.hash ^= keys.tokens[team][index];
 
-    // Can't place a token on wildcards
-    if (index == 0
-        || index == constants::GAME_BOARD_SIZE - 1
-        || index == constants::GAME_BOARD_SIZE * constants::GAME_BOARD_SIZE - constants::GAME_BOARD_SIZE
-        || index == constants::GAME_BOARD_SIZE * constants::GAME_BOARD_SIZE - 1)
-        return constants::INVALID_CARD;
+    state.deadCards = deadCardsAfterPlacing(state.deadCards, state.occupied, index);
+
+    state.lastToken = (int8_t)index;
+    state.lastCompleted = 0;
+    updateWindows(team, index, 1);
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::removeToken(int team, int index)
+{
+    state.tokens[team].reset(index);
+    state.occupied.reset(index);
+    state.hash ^= keys.tokens[team][index];
+    state.deadCards = deadCardsAfterRemoving(state.deadCards, index);
+    updateWindows(team, index, -1);
+}
+
+// Covering the second cell of a card kills it
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::deadCardsAfterPlacing(uint64_t deadCards, Bitboard occupied, int index)
+{
+    int card = board::CARDS.cellCards[index];
+    if ((board::CARDS.masks[card] & ~occupied).empty())
+        deadCards |= 1ull << card;
+    return deadCards;
+}
+
+// Uncovering a cell brings its card back to life
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::deadCardsAfterRemoving(uint64_t deadCards, int index)
+{
+    return deadCards & ~(1ull << board::CARDS.cellCards[index]);
+}
+
+// Adjusts the team's count in every window through the given cell, keeping the threat totals in step
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::updateWindows(int team, int index, int delta)
+{
+    for (int i = 0; i < windows.cellWindowCount[index]; i++)
+    {
+        int window = windows.cellWindows[index][i];
+
+        // A token changes the threat status of the window for its owner and for their opponents
+        for (int t = 0; t < Teams; t++)
+            state.threats[t] -= isThreat(t, window);
+
+        state.windowCounts[team][window] += delta;
+
+        for (int t = 0; t < Teams; t++)
+            state.threats[t] += isThreat(t, window);
+
+        if (delta > 0 && state.windowCounts[team][window] == SequenceLength)
+            state.lastCompleted++;
+    }
+}
+
+// Whether the window holds all but one of the team's tokens and no opposing token blocks the last cell
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::isThreat(int team, int window) const
+{
+    if (state.windowCounts[team][window] != SequenceLength - 1)
+        return false;
+    for (int t = 0; t < Teams; t++)
+    {
+        // Wild corners count for every team, so only cells beyond them are opposing tokens
+        if (t != team && state.windowCounts[t][window] != windows.wildCount[window])
+            return false;
+    }
+    return true;
+}
 
-    // Check whether this card has a token on it
-    auto tokensP1 = getTokenPositions(constants::P1);
-    auto tokensP2 = getTokenPositions(constants::P2);
-    bool tokenedP1 = find(begin(tokensP1), end(tokensP1), index) != end(tokensP1);
-    bool tokenedP2 = find(begin(tokensP2), end(tokensP2), index) != end(tokensP2);
-    bool tokened = tokenedP1 || tokenedP2;
+// Returns the slot in the player's hand holding the given card, or -1 if they don't hold it
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::findInHand(int player, int card) const
+{
+    if (!(state.handCards[player][0] >> card & 1))
+        return -1;
+    return findInHand(state.hands[player], card);
+}
 
-    int cardID = constants::GAME_BOARD[y][x];
-    int suit = cardID / constants::NUM_FACES;
-    int face = cardID % constants::NUM_FACES;
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::findInHand(const uint8_t* hand, int card)
+{
+    for (int i = 0; i < HandSize; i++)
+    {
+        if (hand[i] == card)
+            return i;
+    }
+    return -1;
+}
 
-    function<Card * (int, int)> findCard = [this](int s, int f) {
-        return find(begin(hands[(int)state]), end(hands[(int)state]), Card(s, f));
-    };
-    Card* handEnd = end(hands[(int)state]);
+// The opposing tokens the team could take off with a remove jack: any not in their owner's first sequence
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+Bitboard SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getRemovableCells(int team) const
+{
+    Bitboard removable;
+    for (int t = 0; t < Teams; t++)
+    {
+        if (t != team)
+            removable |= state.tokens[t] & ~state.firstSequence[t];
+    }
+    return removable;
+}
 
-    function<int(Card*, bool)> handleClick = [this, usedCard, index](Card* clicked, bool remove) {
-        *usedCard = *clicked;
+// Works out which card from the current player's hand a click on the board would play
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::findClickMove(int x, int y, Move& move) const
+{
+    int index = board::cellIndex(x, y);
+    int player = state.toMove;
+
+    // Can't place a token on wildcards
+    if (board::WILD_CELLS.test(index))
+        return false;
 
-        if (remove)
+    // If there's no token on the clicked card, play the matching card from the hand, or else a wildcard jack
+    if (!state.occupied.test(index))
+    {
+        const int candidates[] = {
+            constants::GAME_BOARD[y][x],
+            constants::SUIT_DIAMOND + constants::FACE_JACK,
+            constants::SUIT_CLUB + constants::FACE_JACK
+        };
+        for (int card : candidates)
         {
-            // Remove clicked token
-            auto tokenIndex = find(begin(tokenPositions[1 - (int)state]), end(tokenPositions[1 - (int)state]), index);
-            tokenPositions[1 - (int)state].erase(tokenIndex);
+            int handIndex = findInHand(player, card);
+            if (handIndex != -1)
+            {
+                move = Move{ MoveType::PLACE, (uint8_t)handIndex, (uint8_t)card, (uint8_t)index };
+                return true;
+            }
         }
-        else
+        return false;
+    }
+
+    // An opponent's token can be taken off with a remove jack, as long as it isn't part of their first sequence
+    if (getRemovableCells(getTeam(player)).test(index))
+    {
+        const int candidates[] = {
+            constants::SUIT_HEART + constants::FACE_JACK,
+            constants::SUIT_SPADE + constants::FACE_JACK
+        };
+        for (int card : candidates)
         {
-            // Add token on top of clicked card
-            tokenPositions[(int)state].push_back(index);
+            int handIndex = findInHand(player, card);
+            if (handIndex != -1)
+            {
+                move = Move{ MoveType::REMOVE, (uint8_t)handIndex, (uint8_t)card, (uint8_t)index };
+                return true;
+            }
         }
+    }
+    return false;
+}
 
-        // Draw new card and place into hand
-        int newIndex = distance(begin(hands[(int)state]), clicked);
-        hands[(int)state][newIndex] = drawCard();
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::clickCard(int x, int y, Card* usedCard)
+{
+    Move move;
+    if (!findClickMove(x, y, move))
+    {
+        // Return invalid value on unsuccessful placement
+        return constants::INVALID_CARD;
+    }
 
-        // Change state to other player's turn
-        state = (GameState)(1 - (int)state);
-        
-        // Return card index in hand on successful placement
-        return newIndex;
-    };
+    *usedCard = Card::fromIndex(move.card);
+    makeMove(move);
 
-    // If the clicked card is in the current player's hand and there's no token on it
-    Card* cardInHand = findCard(suit, face);
-    if (cardInHand != handEnd && !tokened)
+    // Return card index in hand on successful placement
+    return move.handIndex;
+}
+
+// Plays a legal move for the current player, draws them a replacement card and passes the turn
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::makeMove(const Move& move)
+{
+    MoveUndo undo;
+    makeMove(move, undo);
+}
+
+// Plays a legal move, recording in undo what unmakeMove needs to take it back
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::makeMove(const Move& move, MoveUndo& undo)
+{
+    int player = state.toMove;
+    int team = getTeam(player);
+
+    undo.move = move;
+    undo.winner = state.winner;
+    undo.lastToken = state.lastToken;
+    undo.lastCompleted = state.lastCompleted;
+    undo.firstSequence = state.firstSequence[team];
+    undo.exchanged = state.exchanged;
+
+    // Whatever is played goes face up on the discard pile
+    discardCard(player, move.card);
+
+    if (move.type == MoveType::EXCHANGE)
+    {
+        // Swap the dead card for a new one, and carry on with the same player's turn
+        undo.drawn = drawCard(player);
+        setHandCard(player, move.handIndex, undo.drawn);
+        state.exchanged = 1;
+        state.hash ^= keys.exchanged;
+        return;
+    }
+
+    if (move.type == MoveType::REMOVE)
+    {
+        // Remove clicked token
+        undo.removedTeam = (uint8_t)tokenTeam(move.cell);
+        removeToken(undo.removedTeam, move.cell);
+    }
+    else
+    {
+        // Add token on top of clicked card, and see whether it makes a sequence
+        placeToken(team, move.cell);
+        scoreSequences(team, move.cell);
+    }
+
+    // Draw new card and place into hand
+    undo.drawn = drawCard(player);
+    setHandCard(player, move.handIndex, undo.drawn);
+
+    // Change state to next player's turn, who hasn't exchanged yet
+    if (state.exchanged)
+        state.hash ^= keys.exchanged;
+    state.exchanged = 0;
+    state.toMove = (uint8_t)((player + 1) % Players);
+    state.hash ^= keys.sideToMove[player] ^ keys.sideToMove[state.toMove];
+}
+
+// Takes back the move recorded in undo, which must be the last move made
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+void SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::unmakeMove(const MoveUndo& undo)
+{
+    const Move& move = undo.move;
+
+    // Only moves that end the turn pass it on
+    int player = state.toMove;
+    if (move.type != MoveType::EXCHANGE)
     {
-        return handleClick(cardInHand, false);
+        player = (state.toMove + Players - 1) % Players;
+        state.hash ^= keys.sideToMove[player] ^ keys.sideToMove[state.toMove];
+        state.toMove = (uint8_t)player;
     }
+    int team = getTeam(player);
 
-    // Check if hand contains a wildcard jack
-    Card* wild = findCard(constants::SUIT_DIAMOND / 13, constants::FACE_JACK);
-    if (wild == handEnd)
-        wild = findCard(constants::SUIT_CLUB / 13, constants::FACE_JACK);
+    if (state.exchanged != undo.exchanged)
+        state.hash ^= keys.exchanged;
+    state.exchanged = undo.exchanged;
 
-    if (wild != handEnd && !tokened)
+    // Put the drawn card back on top of the deck and the played card back in the hand
+    if (undo.drawn != board::NO_CARD)
+    {
+        state.deckSize++;
+        state.unseen[player][undo.drawn]++;
+    }
+    setHandCard(player, move.handIndex, move.card);
+    for (int p = 0; p < Players; p++)
     {
-        return handleClick(wild, false);
+        if (p != player)
+            state.unseen[p][move.card]++;
     }
 
-    // Check if hand contains a remove jack
-    Card* remove = findCard(constants::SUIT_HEART / 13, constants::FACE_JACK);
-    if (remove == handEnd)
-        remove = findCard(constants::SUIT_SPADE / 13, constants::FACE_JACK);
+    if (move.type == MoveType::EXCHANGE)
+        return;
 
-    if (remove != handEnd && tokened && 
-        (tokenedP1 && state == GameState::TURN_P2 && !inFirstSequence(constants::P1, x, y) 
-            || tokenedP2 && state == GameState::TURN_P1 && !inFirstSequence(constants::P2, x, y)))
+    if (move.type == MoveType::REMOVE)
+    {
+        state.tokens[undo.removedTeam].set(move.cell);
+        state.occupied.set(move.cell);
+        state.hash ^= keys.tokens[undo.removedTeam][move.cell];
+        updateWindows(undo.removedTeam, move.cell, 1);
+        state.deadCards = deadCardsAfterPlacing(state.deadCards, state.occupied, move.cell);
+    }
+    else
     {
-        return handleClick(remove, true);
+        removeToken(team, move.cell);
     }
 
-    // Return invalid value on unsuccessful placement
-    return constants::INVALID_CARD;
+    setFirstSequence(team, undo.firstSequence);
+    state.winner = undo.winner;
+    state.lastToken = undo.lastToken;
+    state.lastCompleted = undo.lastCompleted;
 }
 
-bool SequenceModel::checkWin(int player, int placedX, int placedY)
-{    
-    // Helper function to check if a board position contains a token of the correct color or a wildcard
-    function<bool(int, int)> tokenExists = [this, player](int x, int y) {
-        if (x < 0 || x >= constants::GAME_BOARD_SIZE || y < 0 || y >= constants::GAME_BOARD_SIZE)
-            return false;
-        int token = y * constants::GAME_BOARD_SIZE + x;
-        return (bool)count(tokenPositions[player].begin(), tokenPositions[player].end(), token) || constants::GAME_BOARD[y][x] == constants::WILD;
-    };
-
-    int minX = placedX - constants::SEQUENCE_LENGTH + 1;
-    int maxX = placedX + constants::SEQUENCE_LENGTH;
-    int minY = placedY - constants::SEQUENCE_LENGTH + 1;
-    int maxY = placedY + constants::SEQUENCE_LENGTH;
-
-    // Player has first sequence already if their firstSequence has been initialized
-    bool hasFirstSequence = firstSequence[player][0] != -1;
-
-    // Check if newly placed token causes a sequence to be created
-
-    auto checkForSequence = [this, hasFirstSequence, tokenExists, player](int minX, int minY, int maxX, int maxY, int dirX, int dirY) {
-        bool takenOneFromFirstSequence = false;
-        int sequenceCount = 0;
-        int x = minX;
-        int y = minY;
-        while (x < maxX && y < maxY)
-        {
-            // If there's a token on this card
-            if (tokenExists(x, y))
-            {
-                // If the token is from an existing sequence
-                int token = y * constants::GAME_BOARD_SIZE + x;
-                if (count(firstSequence[player], firstSequence[player] + constants::SEQUENCE_LENGTH, token))
-                {
-                    // If we've already taken a token from the existing sequence
-                    if (takenOneFromFirstSequence)
-                    {
-                        // Can't borrow more than 1 token from the first sequence; need to reset count to use just this token
-                        sequenceCount = 1;
-                    }
-                    // If we haven't already taken a token from the existing sequence
-                    else
-                    {
-                        // Use the token from the existing sequence
-                        sequenceCount++;
-                        // Remember that we've used a token from the existing sequence
-                        takenOneFromFirstSequence = true;
-                    }
-                }
-                // If the token isn't from an existing sequence, increment token count
-                else sequenceCount++;
-                // If the new token creates a second sequence, return true
-                if (hasFirstSequence && sequenceCount == constants::SEQUENCE_LENGTH)
-                    return true;
-                // If the new token creates the first sequence, make the array contain the tokens used in the sequence we just discovered
-                else if (sequenceCount == constants::SEQUENCE_LENGTH)
-                {
-                    // Walk backwards in the direction (-dirX, -dirY) to find the SEQUENCE_LENGTH (probably 5) tokens used
-                    for (int i = 0; i > -constants::SEQUENCE_LENGTH; i--)
-                    {
-                        firstSequence[player][constants::SEQUENCE_LENGTH + i - 1] = (y * constants::GAME_BOARD_SIZE + x) 
-                            + i * (dirY * constants::GAME_BOARD_SIZE + dirX);
-                    }
-                    // If we're constructing the first sequence, we definitely don't have 2 sequences. Therefore this token did not win
-                    return false;
-                }
-            }
-            // If there's no token on the card, reset sequence count to 0
-            else sequenceCount = 0;
+// Adds a move of the given type on each cell of the mask
+static void addMoves(MoveList& moves, MoveType type, int handIndex, int card, Bitboard cells)
+{
+    while (!cells.empty())
+        moves.add(type, handIndex, card, cells.popLowest());
+}
 
-            x += dirX;
-            y += dirY;
+// Fills the list with every legal move for the current player and returns how many there are.
+// A game that isn't won but leaves the player with no moves is over as a draw.
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::generateMoves(MoveList& moves) const
+{
+    int player = state.toMove;
+
+    moves.clear();
+    if (state.winner != -1)
+        return 0;
+
+    Bitboard open = ~(state.occupied | board::WILD_CELLS) & board::ALL_CELLS;
+    Bitboard removable = getRemovableCells(getTeam(player));
+    return listMoves(state.hands[player], state.handCards[player][0], open, removable, state.deadCards, canExchange(), moves);
+}
+
+// Copies of the same card, and the two jacks of each kind, only contribute their moves once
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::listMoves(const uint8_t* hand, uint64_t held,
+    Bitboard open, Bitboard removable, uint64_t deadCards, bool canExchange, MoveList& moves)
+{
+    // Each distinct card held, with the jacks handled by kind
+    uint64_t twoEyed = held & board::TWO_EYED_JACKS;
+    if (twoEyed)
+    {
+        int card = Bitboard::lowestBit(twoEyed);
+        addMoves(moves, MoveType::PLACE, findInHand(hand, card), card, open);
+    }
+    uint64_t oneEyed = held & board::ONE_EYED_JACKS;
+    if (oneEyed)
+    {
+        int card = Bitboard::lowestBit(oneEyed);
+        addMoves(moves, MoveType::REMOVE, findInHand(hand, card), card, removable);
+    }
+
+    // Every live regular card has at least one open cell
+    held &= ~(board::TWO_EYED_JACKS | board::ONE_EYED_JACKS);
+    uint64_t live = held & ~deadCards;
+    while (live)
+    {
+        int card = Bitboard::lowestBit(live);
+        live &= live - 1;
+        addMoves(moves, MoveType::PLACE, findInHand(hand, card), card, board::CARDS.masks[card] & open);
+    }
+
+    if (canExchange)
+    {
+        uint64_t dead = held & deadCards;
+        while (dead)
+        {
+            int card = Bitboard::lowestBit(dead);
+            dead &= dead - 1;
+            moves.add(MoveType::EXCHANGE, findInHand(hand, card), card, board::NO_CARD);
         }
+    }
+    return moves.size;
+}
+
+// Whether the player to move has any legal move, without listing them
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::hasLegalMove() const
+{
+    int player = state.toMove;
+    if (state.winner != -1)
+        return false;
+
+    uint64_t held = state.handCards[player][0];
+    uint64_t regular = held & ~(board::TWO_EYED_JACKS | board::ONE_EYED_JACKS);
+    if (regular & ~state.deadCards)
+        return true;
+    if ((regular & state.deadCards) && canExchange())
+        return true;
+    if ((held & board::TWO_EYED_JACKS) && !(~(state.occupied | board::WILD_CELLS) & board::ALL_CELLS).empty())
+        return true;
+    return (held & board::ONE_EYED_JACKS) && !getRemovableCells(getTeam(player)).empty();
+}
+
+// Looks for sequences through a newly placed token, recording the team's first sequence or their win
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::scoreSequences(int team, int placed)
+{
+    // Nothing to look for if the token just placed filled no window
+    if (state.lastCompleted == 0)
         return false;
-    };
-    bool temp = checkForSequence(minX, placedY, maxX, placedY + 1, 1, 0) || checkForSequence(placedX, minY, placedX + 1, maxY, 0, 1) ||
-        checkForSequence(minX, minY, maxX, maxY, 1, 1) || checkForSequence(minX, maxY - 1, maxX, maxY, 1, -1);
-    if (temp) {
-        winner = player;
+
+    // Team has first sequence already if their firstSequence has been initialized
+    bool hasFirstSequence = !state.firstSequence[team].empty();
+
+    // Check if newly placed token causes a sequence to be created in any window through it
+    for (int i = 0; i < windows.cellWindowCount[placed]; i++)
+    {
+        int index = windows.cellWindows[placed][i];
+        if (state.windowCounts[team][index] != SequenceLength)
+            continue;
+
+        Bitboard window = windows.masks[index];
+        if (!scoresSequence(window, state.firstSequence[team]))
+            continue;
+
+        // The first sequence is remembered, since a second may only borrow one of its tokens
+        bool won = winsWithSequence(state.firstSequence[team]);
+        if (!hasFirstSequence)
+            setFirstSequence(team, window);
+        if (won)
+            state.winner = team;
+        return won;
     }
-    return temp;
+    return false;
+}
+
+// Can't borrow more than 1 token from the first sequence
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::scoresSequence(Bitboard window, Bitboard firstSequence)
+{
+    return (window & firstSequence).count() <= 1;
+}
+
+// A second sequence wins, and so does the first when one sequence is enough
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::winsWithSequence(Bitboard firstSequence)
+{
+    return !firstSequence.empty() || SEQUENCES_TO_WIN == 1;
 }
 
-int SequenceModel::gameIsWon() const
+// The index of the winning team, or -1 while the game is going on
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::gameIsWon() const
 {
-    return winner;
+    return state.winner;
 }
 
-int SequenceModel::getPlayerIndex() const
+// Whether the game has ended, either won or drawn because the player to move has nothing they can do
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::gameIsOver() const
 {
-    return (int)state;
+    return state.winner != -1 || !hasLegalMove();
 }
 
-Card SequenceModel::getHandCard(int player, int index) const
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getPlayerIndex() const
 {
-    if (player < 0 || player >= constants::NUM_PLAYERS || index < 0 || index > constants::HAND_SIZE)
+    return state.toMove;
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+Card SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getHandCard(int player, int index) const
+{
+    if (player < 0 || player >= Players || index < 0 || index >= HandSize)
         throw invalid_argument("getHandCard arguments must reference a valid card in a player's hand");
-    return hands[player][index];
+    return Card::fromIndex(handCard(player, index));
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+vector<int> SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getTokenPositions(int team) const
+{
+    if (team < 0 || team >= Teams)
+        throw invalid_argument("getTokenPositions argument must be a valid team index");
+
+    // List the team's tokens in board order, but keep the most recently placed token last
+    // so the view can hold it back while its placement is being animated
+    vector<int> positions;
+    Bitboard remaining = tokens(team);
+    while (!remaining.empty())
+    {
+        int index = remaining.popLowest();
+        if (index != state.lastToken)
+            positions.push_back(index);
+    }
+    if (state.lastToken != -1 && tokens(team).test(state.lastToken))
+        positions.push_back(state.lastToken);
+    return positions;
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+const Bitboard& SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getTokens(int team) const
+{
+    if (team < 0 || team >= Teams)
+        throw invalid_argument("getTokens argument must be a valid team index");
+    return tokens(team);
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+const Bitboard& SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getFirstSequence(int team) const
+{
+    if (team < 0 || team >= Teams)
+        throw invalid_argument("getFirstSequence argument must be a valid team index");
+    return firstSequence(team);
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+const Bitboard& SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getOccupied() const
+{
+    return state.occupied;
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+const typename SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::Hand& SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getHand(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getHand argument must be a valid player index");
+    return state.hands[player];
+}
+
+// The team whose token is on the cell, or -1 if it's empty
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::owner(int x, int y) const
+{
+    if (x < 0 || x >= BoardSize || y < 0 || y >= BoardSize)
+        throw invalid_argument("owner x and y indices must be in range");
+    return tokenTeam(board::cellIndex(x, y));
+}
+
+// The cell of the most recently placed token, or -1 if none has been placed
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getLastToken() const
+{
+    return state.lastToken;
+}
+
+// The number of copies of a card (by card index) in the player's hand
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getCardCount(int player, int card) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getCardCount player argument must be a valid player index");
+    if (card < 0 || card >= board::NUM_CARDS)
+        throw invalid_argument("getCardCount card argument must be a valid card index");
+    int count = 0;
+    for (int k = 0; k < board::COPIES_PER_CARD; k++)
+        count += state.handCards[player][k] >> card & 1;
+    return count;
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::hasTwoEyedJack(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("hasTwoEyedJack argument must be a valid player index");
+    return (state.handCards[player][0] & board::TWO_EYED_JACKS) != 0;
 }
 
-vector<int> SequenceModel::getTokenPositions(int player) const
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::hasOneEyedJack(int player) const
 {
-    if (player < 0 || player >= constants::NUM_PLAYERS)
-        throw invalid_argument("getTokenPositions argument must be a valid player index");
-    return tokenPositions[player];
+    if (player < 0 || player >= Players)
+        throw invalid_argument("hasOneEyedJack argument must be a valid player index");
+    return (state.handCards[player][0] & board::ONE_EYED_JACKS) != 0;
 }
 
-bool SequenceModel::inFirstSequence(int player, int x, int y) const
+// Whether both cells of a card (by card index) are covered, so it can only be exchanged. Jacks are never dead.
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::isDeadCard(int card) const
 {
-    if (player < 0 || player >= constants::NUM_PLAYERS)
-        throw invalid_argument("inFirstSequence player argument must be a valid player index");
-    if (x < 0 || x >= constants::GAME_BOARD_SIZE || y < 0 || y >= constants::GAME_BOARD_SIZE)
+    if (card < 0 || card >= board::NUM_CARDS)
+        throw invalid_argument("isDeadCard argument must be a valid card index");
+    return (state.deadCards >> card & 1) != 0;
+}
+
+// The dead cards in the player's hand, with one bit per card index
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getDeadCards(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getDeadCards argument must be a valid player index");
+    return state.handCards[player][0] & state.deadCards;
+}
+
+// Whether the player to move may still exchange a dead card: once a turn, and only while there are cards to draw
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::canExchange() const
+{
+    return !state.exchanged && state.deckSize > 0;
+}
+
+// The number of copies of a card (by card index) the player hasn't seen in their hand or played
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getUnseenCount(int player, int card) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getUnseenCount player argument must be a valid player index");
+    if (card < 0 || card >= board::NUM_CARDS)
+        throw invalid_argument("getUnseenCount card argument must be a valid card index");
+    return state.unseen[player][card];
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getUnseenTwoEyedJacks(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getUnseenTwoEyedJacks argument must be a valid player index");
+    return state.unseen[player][constants::SUIT_DIAMOND + constants::FACE_JACK] + state.unseen[player][constants::SUIT_CLUB + constants::FACE_JACK];
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getUnseenOneEyedJacks(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("getUnseenOneEyedJacks argument must be a valid player index");
+    return state.unseen[player][constants::SUIT_HEART + constants::FACE_JACK] + state.unseen[player][constants::SUIT_SPADE + constants::FACE_JACK];
+}
+
+// The number of windows in which the team is one token away from a sequence
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+int SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getThreatCount(int team) const
+{
+    if (team < 0 || team >= Teams)
+        throw invalid_argument("getThreatCount argument must be a valid team index");
+    return state.threats[team];
+}
+
+// Whether the most recently placed token filled a whole window for its owner
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::lastTokenCompletedWindow() const
+{
+    return state.lastCompleted > 0;
+}
+
+// A key identifying the position, for transposition tables and deduplicating game records
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getHash() const
+{
+    return state.hash;
+}
+
+// The seed the current game was started from, which together with the moves played reproduces the game
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+uint64_t SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getSeed() const
+{
+    return seed;
+}
+
+// The whole game as plain data, for cloning or storing cheaply
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+const typename SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::State& SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::getState() const
+{
+    return state;
+}
+
+// The game as the given player sees it, with the other hands and the deck order hidden
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+typename SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::Observation SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::observe(int player) const
+{
+    if (player < 0 || player >= Players)
+        throw invalid_argument("observe argument must be a valid player index");
+
+    // Empty the other hands through setHandCard so that their cards also leave the hash.
+    // What the other players haven't seen would give their hands away, so it goes too.
+    SequenceRules seen(state);
+    for (int p = 0; p < Players; p++)
+    {
+        if (p == player)
+            continue;
+        for (int card = 0; card < board::NUM_CARDS; card++)
+            seen.state.unseen[p][card] = 0;
+        for (int i = 0; i < HandSize; i++)
+        {
+            if (seen.state.hands[p][i] != board::NO_CARD)
+            {
+                seen.setHandCard(p, i, board::NO_CARD);
+                seen.state.hands[p][i] = board::HIDDEN_CARD;
+            }
+        }
+    }
+    // Cards already drawn stay in the deck array past deckSize in the order they were dealt, so hide all of it
+    for (int i = 0; i < constants::DECK_SIZE; i++)
+        seen.state.deck[i] = board::HIDDEN_CARD;
+
+    Observation observation;
+    observation.player = (uint8_t)player;
+    observation.state = seen.state;
+    for (int card = 0; card < board::NUM_CARDS; card++)
+        observation.unseen[card] = state.unseen[player][card];
+    return observation;
+}
+
+// Samples a whole game consistent with an observation, dealing the unseen cards at random into the hidden
+// hand slots and the deck
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams> SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::determinize(const Observation& observation, Random& rng)
+{
+    uint8_t unseen[constants::DECK_SIZE];
+    int count = 0;
+    for (int card = 0; card < board::NUM_CARDS; card++)
+    {
+        for (int k = 0; k < observation.unseen[card]; k++)
+            unseen[count++] = (uint8_t)card;
+    }
+    rng.shuffle(unseen, unseen + count);
+
+    SequenceRules game(observation.state);
+    for (int p = 0; p < Players; p++)
+    {
+        for (int i = 0; i < HandSize; i++)
+        {
+            if (game.state.hands[p][i] == board::HIDDEN_CARD)
+            {
+                game.state.hands[p][i] = board::NO_CARD;
+                game.setHandCard(p, i, unseen[--count]);
+            }
+        }
+    }
+    for (int i = 0; i < game.state.deckSize; i++)
+        game.state.deck[i] = unseen[--count];
+
+    // Every copy not yet played is unseen by each other player unless it is in their own hand
+    int player = observation.player;
+    for (int card = 0; card < board::NUM_CARDS; card++)
+    {
+        int unplayed = observation.unseen[card];
+        for (int k = 0; k < board::COPIES_PER_CARD; k++)
+            unplayed += game.state.handCards[player][k] >> card & 1;
+
+        for (int p = 0; p < Players; p++)
+        {
+            if (p == player)
+                continue;
+            int held = 0;
+            for (int k = 0; k < board::COPIES_PER_CARD; k++)
+                held += game.state.handCards[p][k] >> card & 1;
+            game.state.unseen[p][card] = (uint8_t)(unplayed - held);
+        }
+    }
+    return game;
+}
+
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams>
+bool SequenceRules<BoardSize, SequenceLength, Players, HandSize, Teams>::inFirstSequence(int team, int x, int y) const
+{
+    if (team < 0 || team >= Teams)
+        throw invalid_argument("inFirstSequence team argument must be a valid team index");
+    if (x < 0 || x >= BoardSize || y < 0 || y >= BoardSize)
         throw invalid_argument("inFirstSequence x and y indices must be in range");
-    return (bool)count(firstSequence[player], firstSequence[player] + constants::SEQUENCE_LENGTH, y * constants::GAME_BOARD_SIZE + x);
-}
\ No newline at end of file
+    return firstSequence(team).test(board::cellIndex(x, y));
+}
+
+// Every variant in use must be listed here, alongside its extern declaration in the header
+template class SequenceRules<10, 5, 2, 7>;
+template class SequenceRules<10, 4, 2, 7>;
+template class SequenceRules<10, 3, 2, 7>;
+template class SequenceRules<10, 5, 3, 6>;
+template class SequenceRules<10, 5, 4, 6, 2>;
+template class SequenceRules<10, 5, 6, 5, 2>;
+template class SequenceRules<10, 5, 6, 5, 3>;
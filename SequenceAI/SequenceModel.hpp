@@ -1,43 +1,177 @@
 #pragma once
 
+#include "Bitboard.hpp"
+#include "Board.hpp"
 #include "Card.hpp"
 #include "Constants.hpp"
+#include "Move.hpp"
+#include "Observation.hpp"
+#include "Random.hpp"
+#include "SequenceState.hpp"
+#include "Zobrist.hpp"
 
 #include <set>
 #include <vector>
 #include <string>
 
-using namespace sf;
 using namespace std;
 
-class SequenceModel
+// The rules of Sequence, compiled separately for each variant so that every loop over players, hand slots
+// and windows has a constant trip count and every array is sized exactly.
+// Only the standard 10x10 board exists, so BoardSize is there to make the variant explicit rather than to vary.
+// Players take turns in index order and play for team (player % Teams), so team-mates alternate with opponents.
+template <int BoardSize, int SequenceLength, int Players, int HandSize, int Teams = Players>
+class SequenceRules
 {
+	static_assert(BoardSize == constants::GAME_BOARD_SIZE, "Only the standard board layout is defined");
+	static_assert(SequenceLength >= 2 && SequenceLength <= BoardSize, "A sequence must fit on the board");
+	static_assert(Teams >= 2 && Players % Teams == 0, "Players must split evenly into at least two teams");
+	static_assert(HandSize > 0 && Players * HandSize <= constants::DECK_SIZE, "Every hand must be dealt from the deck");
+	// A jack moves to at most every cell, each other distinct card held to at most its two cells, and each card
+	// may be exchanged
+	static_assert(board::NUM_CELLS + (board::CELLS_PER_CARD + 1) * HandSize <= MoveList::CAPACITY, "A position's moves must fit in a MoveList");
+
 public:
-	enum class GameState { TURN_P1, TURN_P2 };
+	static const int BOARD_SIZE = BoardSize;
+	static const int SEQUENCE_LENGTH = SequenceLength;
+	static const int NUM_PLAYERS = Players;
+	static const int HAND_SIZE = HandSize;
+	static const int NUM_TEAMS = Teams;
+	// Two teams play to two sequences, while three or more play to one
+	static const int SEQUENCES_TO_WIN = Teams == 2 ? 2 : 1;
+
+	using State = SequenceState<SequenceLength, Players, HandSize, Teams>;
+	using Observation = SequenceObservation<SequenceLength, Players, HandSize, Teams>;
+	using Hand = uint8_t[HandSize];
+
+	static constexpr int getTeam(int player) { return player % Teams; }
 
-	SequenceModel();
+	SequenceRules();
+	explicit SequenceRules(uint64_t seed);
+	explicit SequenceRules(const State& state);
+
+	void reset(uint64_t seed);
+	uint64_t getSeed() const;
 
 	int clickCard(int x, int y, Card* usedCard);
-	bool checkWin(int player, int placedX, int placedY);
+	int generateMoves(MoveList& moves) const;
+	void makeMove(const Move& move);
+	void makeMove(const Move& move, MoveUndo& undo);
+	void unmakeMove(const MoveUndo& undo);
 	int gameIsWon() const;
+	bool gameIsOver() const;
+	bool hasLegalMove() const;
 
 	int getPlayerIndex() const;
 	Card getHandCard(int player, int index) const;
-	vector<int> getTokenPositions(int player) const;
-	bool inFirstSequence(int player, int x, int y) const;
+	vector<int> getTokenPositions(int team) const;
+	bool inFirstSequence(int team, int x, int y) const;
+
+	// Views straight into the state, for code that reads the board every frame or every node
+	const Bitboard& getTokens(int team) const;
+	const Bitboard& getFirstSequence(int team) const;
+	const Bitboard& getOccupied() const;
+	const Hand& getHand(int player) const;
+	int owner(int x, int y) const;
+	int getLastToken() const;
+
+	// Unchecked, inlined versions of the accessors above for the engine's own loops. The arguments must already
+	// be in range; the get* versions check them and throw.
+	uint8_t handCard(int player, int index) const noexcept { return state.hands[player][index]; }
+	const Bitboard& tokens(int team) const noexcept { return state.tokens[team]; }
+	const Bitboard& firstSequence(int team) const noexcept { return state.firstSequence[team]; }
+
+	// The team whose token is on the cell (by cell index), or -1 if it's empty
+	int tokenTeam(int index) const noexcept
+	{
+		if (!state.occupied.test(index))
+			return -1;
+		for (int t = 0; t < Teams; t++)
+		{
+			if (state.tokens[t].test(index))
+				return t;
+		}
+		return -1;
+	}
+
+	int getCardCount(int player, int card) const;
+	bool hasTwoEyedJack(int player) const;
+	bool hasOneEyedJack(int player) const;
+	bool isDeadCard(int card) const;
+	uint64_t getDeadCards(int player) const;
+	bool canExchange() const;
+
+	int getUnseenCount(int player, int card) const;
+	int getUnseenTwoEyedJacks(int player) const;
+	int getUnseenOneEyedJacks(int player) const;
+
+	int getThreatCount(int team) const;
+	bool lastTokenCompletedWindow() const;
+	uint64_t getHash() const;
+	// The hash worked out from scratch, which getHash keeps up to date incrementally
+	uint64_t computeHash() const;
+
+	const State& getState() const;
+
+	Observation observe(int player) const;
+	static SequenceRules determinize(const Observation& observation, Random& rng);
+
+	// The rules SequenceBatch shares, working on plain values since it keeps its games in columns rather than States.
+	// Lists the moves for a hand holding the card set held, given the cells open to a wild jack and those a remove
+	// jack could clear
+	static int listMoves(const uint8_t* hand, uint64_t held, Bitboard open, Bitboard removable, uint64_t deadCards,
+		bool canExchange, MoveList& moves);
+	static int findInHand(const uint8_t* hand, int card);
+	// The dead cards once a token has been placed on, or taken off, the cell
+	static uint64_t deadCardsAfterPlacing(uint64_t deadCards, Bitboard occupied, int index);
+	static uint64_t deadCardsAfterRemoving(uint64_t deadCards, int index);
+	// Whether completing the window scores a sequence for a team with the given first sequence, and whether
+	// scoring one wins
+	static bool scoresSequence(Bitboard window, Bitboard firstSequence);
+	static bool winsWithSequence(Bitboard firstSequence);
 
 private:
-	GameState state;
+	State state;
 
-	vector<Card> deck;
-	Card hands[constants::NUM_PLAYERS][constants::HAND_SIZE];
+	// The seed the deck was shuffled with. The generator itself is only needed for the shuffle, so it isn't
+	// kept, which keeps copies of a game small.
+	uint64_t seed;
 
-	vector<int> tokenPositions[constants::NUM_PLAYERS];
-	int firstSequence[constants::NUM_PLAYERS][constants::SEQUENCE_LENGTH];
+	uint8_t drawCard(int player);
+	void discardCard(int player, uint8_t card);
+	void setHandCard(int player, int index, uint8_t card);
+	void setFirstSequence(int team, Bitboard cells);
 
-	int winner;
+	int findInHand(int player, int card) const;
+	Bitboard getRemovableCells(int team) const;
+	bool findClickMove(int x, int y, Move& move) const;
 
-	void reset();
-	Card drawCard();
+	bool scoreSequences(int team, int index);
+	void placeToken(int team, int index);
+	void removeToken(int team, int index);
+	void updateWindows(int team, int index, int delta);
+	bool isThreat(int team, int window) const;
+
+	static constexpr const board::WindowTable<SequenceLength>& windows = board::WINDOWS<SequenceLength>;
+	static constexpr const zobrist::KeyTable<Players, Teams>& keys = zobrist::KEYS<Players, Teams>;
 };
 
+// The variants in use, instantiated in SequenceModel.cpp
+extern template class SequenceRules<10, 5, 2, 7>;
+extern template class SequenceRules<10, 4, 2, 7>;
+extern template class SequenceRules<10, 3, 2, 7>;
+extern template class SequenceRules<10, 5, 3, 6>;
+extern template class SequenceRules<10, 5, 4, 6, 2>;
+extern template class SequenceRules<10, 5, 6, 5, 2>;
+extern template class SequenceRules<10, 5, 6, 5, 3>;
+
+// The standard game
+using SequenceModel = SequenceRules<constants::GAME_BOARD_SIZE, constants::SEQUENCE_LENGTH, constants::NUM_PLAYERS, constants::HAND_SIZE, constants::NUM_TEAMS>;
+
+// The official multi-player formats
+using ThreePlayerModel = SequenceRules<constants::GAME_BOARD_SIZE, constants::SEQUENCE_LENGTH, 3, 6>;
+using TwoVersusTwoModel = SequenceRules<constants::GAME_BOARD_SIZE, constants::SEQUENCE_LENGTH, 4, 6, 2>;
+using ThreeVersusThreeModel = SequenceRules<constants::GAME_BOARD_SIZE, constants::SEQUENCE_LENGTH, 6, 5, 2>;
+using ThreeTeamsOfTwoModel = SequenceRules<constants::GAME_BOARD_SIZE, constants::SEQUENCE_LENGTH, 6, 5, 3>;
+
+static_assert(std::is_trivially_copyable<SequenceModel>::value, "Cloning a SequenceModel must not allocate");
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Bitboard.hpp"
+#include "Board.hpp"
+#include "Constants.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+// The complete state of a game as plain data with no heap members, so that copying a game is a memcpy.
+// Cards are stored as card indices (suit * NUM_FACES + face), with board::NO_CARD for an empty slot.
+// Every array is sized for the rules variant, so smaller variants copy less.
+// Players sit in turn order and belong to team (player % Teams), and the board is shared by the teams.
+template <int SequenceLength, int Players, int HandSize, int Teams>
+struct SequenceState
+{
+	static const int NUM_WINDOWS = board::numWindows(SequenceLength);
+
+	// One bit per board cell covered by each team's tokens
+	Bitboard tokens[Teams];
+	// The cells covered by any team's tokens
+	Bitboard occupied;
+	// The cards (one bit per card index) whose cells are both covered, so they can no longer be played
+	uint64_t deadCards;
+	// The cells of each team's first completed sequence, empty until they have one
+	Bitboard firstSequence[Teams];
+
+	// Zobrist hash of the tokens, first sequences, hands and side to move, kept up to date by every change
+	uint64_t hash;
+
+	// For each team, the number of cells in each window covered by their tokens or a wild corner
+	uint8_t windowCounts[Teams][NUM_WINDOWS];
+	// For each team, the number of windows one token short of a sequence with the last cell still open
+	uint16_t threats[Teams];
+
+	uint8_t hands[Players][HandSize];
+	// The same hands as sets of card indices: bit c of handCards[p][k] is set when player p holds more than k copies of card c
+	uint64_t handCards[Players][board::COPIES_PER_CARD];
+
+	// The shuffled deck. Cards are drawn from the end, so only the first deckSize entries are still to be drawn.
+	uint8_t deck[constants::DECK_SIZE];
+	uint8_t deckSize;
+
+	// For each player and card index, the number of copies they haven't seen: not in their hand and not played yet.
+	// This is all the searches need of the discard pile, so the pile itself isn't kept.
+	uint8_t unseen[Players][board::NUM_CARDS];
+
+	// Index of the player whose turn it is
+	uint8_t toMove;
+	// Whether the player to move has used their one exchange of a dead card this turn
+	uint8_t exchanged;
+	// Index of the winning team, or -1 while the game is going on
+	int8_t winner;
+	// Cell index of the most recently placed token, or -1 if none has been placed
+	int8_t lastToken;
+	// The number of windows the most recently placed token completed
+	uint8_t lastCompleted;
+};
+
+static_assert(std::is_trivially_copyable<SequenceState<constants::SEQUENCE_LENGTH, constants::NUM_PLAYERS, constants::HAND_SIZE, constants::NUM_TEAMS>>::value,
+	"SequenceState must be copyable with memcpy");
@@ -0,0 +1,228 @@
+#include "TreeParallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+template <class Rules>
+TreeParallelMCTS<Rules>::TreeParallelMCTS(int threads, uint64_t seed, double exploration, int maxNodes) : threads(threads),
+    maxNodes(maxNodes), exploration(exploration), nodeCount(0), stats{ 0, 0, 0 }
+{
+    if (threads < 1)
+        throw invalid_argument("TreeParallelMCTS needs at least one thread");
+    if (maxNodes < 1)
+        throw invalid_argument("TreeParallelMCTS needs room for at least the root node");
+    nodes = vector<Node>(maxNodes);
+
+    for (int i = 0; i < threads; i++)
+        generators.emplace_back(seed + i);
+}
+
+template <class Rules>
+SearchResult TreeParallelMCTS<Rules>::search(const Rules& game, const SearchLimits& limits)
+{
+    if (limits.iterations <= 0 && limits.seconds <= 0.0)
+        throw invalid_argument("search needs an iteration or time limit");
+    if (!game.hasLegalMove() || game.gameIsWon() != -1)
+        throw invalid_argument("search needs a game with a legal move to play");
+
+    Node& root = nodes[0];
+    root.move = Move();
+    root.team = 0;
+    root.children.store(0, memory_order_relaxed);
+    root.visits.store(0, memory_order_relaxed);
+    root.halfPoints.store(0, memory_order_relaxed);
+    root.virtualLoss.store(0, memory_order_relaxed);
+    nodeCount.store(1, memory_order_relaxed);
+
+    vector<TreeParallelStats> threadStats(threads, TreeParallelStats{ 0, 0, 0 });
+    expand(0, game, threadStats[0]);
+
+    // Each thread keeps its own iteration count and statistics, and only the shared iteration budget, if there
+    // is one, is claimed through a common counter
+    SearchClock clock(limits);
+    atomic<long long> claimed(0);
+    vector<long long> iterations(threads, 0);
+    vector<thread> workers;
+    workers.reserve(threads - 1);
+    for (int i = 1; i < threads; i++)
+    {
+        workers.emplace_back([this, &game, &limits, &claimed, &iterations, &threadStats, i]() {
+            work(game, limits, generators[i], claimed, iterations[i], threadStats[i]);
+        });
+    }
+    work(game, limits, generators[0], claimed, iterations[0], threadStats[0]);
+    for (thread& worker : workers)
+        worker.join();
+    double elapsed = clock.elapsed();
+
+    stats = TreeParallelStats{ 0, 0, 0 };
+    long long total = 0;
+    for (int i = 0; i < threads; i++)
+    {
+        total += iterations[i];
+        stats.virtualLossHits += threadStats[i].virtualLossHits;
+        stats.wastedExpansions += threadStats[i].wastedExpansions;
+        stats.wastedNodes += threadStats[i].wastedNodes;
+    }
+
+    uint64_t children = root.children.load(memory_order_acquire);
+    int first = (int)(children >> 32);
+    int count = (int)(children & 0xffffffff);
+    int best = first;
+    for (int c = first; c < first + count; c++)
+    {
+        if (nodes[c].visits.load(memory_order_relaxed) > nodes[best].visits.load(memory_order_relaxed))
+            best = c;
+    }
+
+    if (count == 0)
+        return unsearchedResult(game, total, elapsed, min(nodeCount.load(memory_order_relaxed), maxNodes));
+    int visits = nodes[best].visits.load(memory_order_relaxed);
+    return SearchResult{ nodes[best].move, total, elapsed, min(nodeCount.load(memory_order_relaxed), maxNodes), visits,
+        visits > 0 ? nodes[best].halfPoints.load(memory_order_relaxed) / (2.0 * visits) : 0.0 };
+}
+
+template <class Rules>
+void TreeParallelMCTS<Rules>::work(const Rules& root, const SearchLimits& limits, Random& generator, atomic<long long>& claimed,
+    long long& iterationCount, TreeParallelStats& threadStats)
+{
+    // The generator, count and statistics change every iteration, so they live in this thread's stack frame
+    // while it searches and are only written back at the end. Side by side in the shared vectors they would
+    // put several threads' hot state on one cache line.
+    Random rng = generator;
+    TreeParallelStats local = threadStats;
+    long long iterations = 0;
+
+    SearchClock clock(limits);
+    while (limits.iterations <= 0 || claimed.fetch_add(1, memory_order_relaxed) < limits.iterations)
+    {
+        iterate(root, rng, local);
+        iterations++;
+        if (clock.expired(iterations))
+            break;
+    }
+
+    generator = rng;
+    threadStats = local;
+    iterationCount = iterations;
+}
+
+template <class Rules>
+void TreeParallelMCTS<Rules>::iterate(const Rules& root, Random& rng, TreeParallelStats& local)
+{
+    int path[constants::DECK_SIZE + 2];
+    int depth = 0;
+    path[depth++] = 0;
+
+    Rules game = root;
+    int node = 0;
+
+    // Selection, marking each node on the way down with a virtual loss
+    while (nodes[node].children.load(memory_order_acquire) != 0)
+    {
+        node = selectChild(node, local);
+        game.makeMove(nodes[node].move);
+        path[depth++] = node;
+    }
+
+    // Expansion, then a step into one of the new children
+    if (nodes[node].visits.load(memory_order_relaxed) > 0 && game.gameIsWon() == -1 && expand(node, game, local))
+    {
+        node = selectChild(node, local);
+        game.makeMove(nodes[node].move);
+        path[depth++] = node;
+    }
+
+    int winner = playOut(game, rng);
+
+    // Backpropagation, taking back the virtual losses. The root never gets one.
+    for (int i = 0; i < depth; i++)
+    {
+        Node& visited = nodes[path[i]];
+        visited.halfPoints.fetch_add(winner == -1 ? 1 : winner == visited.team ? 2 : 0, memory_order_relaxed);
+        visited.visits.fetch_add(1, memory_order_relaxed);
+        if (i > 0)
+            visited.virtualLoss.fetch_sub(1, memory_order_relaxed);
+    }
+}
+
+// UCT over the children, counting every thread searching below a child as a loss for it, and adds this
+// thread's virtual loss to the child it picks
+template <class Rules>
+int TreeParallelMCTS<Rules>::selectChild(int node, TreeParallelStats& local)
+{
+    const Node& parent = nodes[node];
+    uint64_t children = parent.children.load(memory_order_acquire);
+    int first = (int)(children >> 32);
+    int count = (int)(children & 0xffffffff);
+
+    int parentVisits = parent.visits.load(memory_order_relaxed) + parent.virtualLoss.load(memory_order_relaxed);
+    double logVisits = log((double)max(parentVisits, 1));
+
+    int best = first;
+    double bestScore = -1.0;
+    for (int c = first; c < first + count; c++)
+    {
+        const Node& child = nodes[c];
+        int tries = child.visits.load(memory_order_relaxed) + child.virtualLoss.load(memory_order_relaxed);
+        if (tries == 0)
+        {
+            best = c;
+            break;
+        }
+        double score = child.halfPoints.load(memory_order_relaxed) / (2.0 * tries) + exploration * sqrt(logVisits / tries);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = c;
+        }
+    }
+
+    if (nodes[best].virtualLoss.fetch_add(1, memory_order_relaxed) > 0)
+        local.virtualLossHits++;
+    return best;
+}
+
+// Gives the node a child for every legal move, unless the pool has no room for them. Returns whether the node
+// has children afterwards, whichever thread gave them.
+template <class Rules>
+bool TreeParallelMCTS<Rules>::expand(int node, const Rules& game, TreeParallelStats& local)
+{
+    MoveList moves;
+    if (game.generateMoves(moves) == 0)
+        return false;
+
+    // Check before claiming, so a full pool doesn't keep pushing nodeCount up
+    if (nodeCount.load(memory_order_relaxed) + moves.size > maxNodes)
+        return nodes[node].children.load(memory_order_acquire) != 0;
+    int first = nodeCount.fetch_add(moves.size, memory_order_relaxed);
+    if (first + moves.size > maxNodes)
+        return nodes[node].children.load(memory_order_acquire) != 0;
+
+    uint8_t team = (uint8_t)Rules::getTeam(game.getPlayerIndex());
+    for (int i = 0; i < moves.size; i++)
+    {
+        Node& child = nodes[first + i];
+        child.move = moves[i];
+        child.team = team;
+        child.children.store(0, memory_order_relaxed);
+        child.visits.store(0, memory_order_relaxed);
+        child.halfPoints.store(0, memory_order_relaxed);
+        child.virtualLoss.store(0, memory_order_relaxed);
+    }
+
+    // Publish the whole block at once. The release makes the children's fields visible to any thread that
+    // sees the block.
+    uint64_t expected = 0;
+    uint64_t block = (uint64_t)first << 32 | (uint64_t)moves.size;
+    if (!nodes[node].children.compare_exchange_strong(expected, block, memory_order_acq_rel, memory_order_acquire))
+    {
+        local.wastedExpansions++;
+        local.wastedNodes += moves.size;
+    }
+    return true;
+}
+
+template class TreeParallelMCTS<SequenceModel>;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Agent.hpp"
+#include "MCTS.hpp"
+#include "Random.hpp"
+#include "RootParallel.hpp"
+#include "Search.hpp"
+#include "SequenceModel.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// How the last tree-parallel search's threads got in each other's way
+struct TreeParallelStats
+{
+	// Steps into a child that another thread was already searching below
+	long long virtualLossHits;
+	// Nodes expanded by two threads at once, where one expansion had to be thrown away, and the pool space it wasted
+	long long wastedExpansions;
+	long long wastedNodes;
+};
+
+// Tree parallelization: every thread runs UCT iterations on one shared tree, so a single move gets the whole
+// machine's playouts. Node statistics are atomic counters and nothing is locked.
+// A thread passing through a node adds a virtual loss to it until its playout comes back, which makes the node
+// look worse to the other threads and spreads them over different lines.
+// A leaf is expanded by building its children in a block claimed from the pool and publishing them with one
+// compare-and-swap. If another thread published first, the block is abandoned and counted as wasted.
+// This searches the true game like MCTS does.
+template <class Rules>
+class TreeParallelMCTS
+{
+public:
+	using Position = Rules;
+
+	TreeParallelMCTS(int threads, uint64_t seed, double exploration = 0.7, int maxNodes = 1 << 20);
+
+	// The iteration limit is shared by all the threads
+	SearchResult search(const Rules& game, const SearchLimits& limits);
+	const TreeParallelStats& getStats() const { return stats; }
+
+	int getThreadCount() const { return threads; }
+
+private:
+	struct Node
+	{
+		Move move;
+		// The team that played move to reach this node
+		uint8_t team;
+		// The first child's index in the high half and the number of children in the low half, or 0 until
+		// the node is expanded. Children always come after the root, so a real block is never 0.
+		atomic<uint64_t> children;
+		atomic<int> visits;
+		// Results for team, in half points so they can be added atomically: 2 for a win, 1 for a draw
+		atomic<int> halfPoints;
+		// Threads currently searching below this node
+		atomic<int> virtualLoss;
+	};
+
+	int threads;
+	int maxNodes;
+	double exploration;
+	// One generator per thread, so playouts never share one
+	vector<Random> generators;
+	vector<Node> nodes;
+	atomic<int> nodeCount;
+	TreeParallelStats stats;
+
+	void work(const Rules& root, const SearchLimits& limits, Random& generator, atomic<long long>& claimed,
+		long long& iterationCount, TreeParallelStats& threadStats);
+	void iterate(const Rules& root, Random& rng, TreeParallelStats& local);
+	int selectChild(int node, TreeParallelStats& local);
+	bool expand(int node, const Rules& game, TreeParallelStats& local);
+};
+
+extern template class TreeParallelMCTS<SequenceModel>;
+
+// The two ways of spreading a search over several threads
+enum class Parallelism { ROOT, TREE };
+
+// Plays the move a parallel MCTS search recommends, with whichever parallelization suits the core count.
+// The tree search shares one tree, so like MctsAgent it searches one deal of the cards its player can't see,
+// drawn afresh for every move. The root search gives every thread a deal of its own.
+class ParallelMctsAgent : public Agent
+{
+public:
+	ParallelMctsAgent(Parallelism parallelism, int threads, uint64_t seed, const SearchLimits& limits) : limits(limits),
+		rng(seed + threads)
+	{
+		if (parallelism == Parallelism::TREE)
+			tree.reset(new TreeParallelMCTS<SequenceModel>(threads, seed));
+		else
+			root.reset(new RootParallel<MCTS<SequenceModel>>(threads, seed));
+	}
+
+	Move chooseMove(const SequenceModel& game) override
+	{
+		SequenceModel::Observation observation = game.observe(game.getPlayerIndex());
+		if (root)
+			return root->search(observation, limits).move;
+		return tree->search(SequenceModel::determinize(observation, rng), limits).move;
+	}
+
+private:
+	unique_ptr<TreeParallelMCTS<SequenceModel>> tree;
+	unique_ptr<RootParallel<MCTS<SequenceModel>>> root;
+	SearchLimits limits;
+	// The tree search's threads use seed to seed + threads - 1, so its deals come from the next seed
+	Random rng;
+};
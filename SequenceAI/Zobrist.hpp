@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Board.hpp"
+#include "Constants.hpp"
+
+#include <cstdint>
+
+// Random keys for hashing a position. A position's hash is the XOR of the keys of everything in it,
+// so each change to the position updates the hash with a single XOR.
+namespace zobrist {
+	// Tokens and sequences belong to teams, while hands and turns belong to players
+	template <int Players, int Teams>
+	struct KeyTable
+	{
+		uint64_t tokens[Teams][board::NUM_CELLS];
+		uint64_t firstSequence[Teams][board::NUM_CELLS];
+		// One key for each copy of a card held, so that holding both copies differs from holding neither
+		uint64_t hands[Players][board::NUM_CARDS][board::COPIES_PER_CARD];
+		uint64_t sideToMove[Players];
+		// Set while the player to move has already exchanged a dead card
+		uint64_t exchanged;
+	};
+
+	// SplitMix64, which gives well-mixed keys from consecutive seeds
+	constexpr uint64_t mix(uint64_t seed)
+	{
+		uint64_t z = seed + 0x9e3779b97f4a7c15ull;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	template <int Players, int Teams>
+	constexpr KeyTable<Players, Teams> makeKeys()
+	{
+		KeyTable<Players, Teams> table{};
+		uint64_t seed = 0;
+		for (int t = 0; t < Teams; t++)
+		{
+			for (int i = 0; i < board::NUM_CELLS; i++)
+			{
+				table.tokens[t][i] = mix(seed++);
+				table.firstSequence[t][i] = mix(seed++);
+			}
+		}
+		for (int p = 0; p < Players; p++)
+		{
+			for (int card = 0; card < board::NUM_CARDS; card++)
+				for (int copy = 0; copy < board::COPIES_PER_CARD; copy++)
+					table.hands[p][card][copy] = mix(seed++);
+			// The first player to move needs no key of their own
+			table.sideToMove[p] = p == constants::P1 ? 0 : mix(seed++);
+		}
+		table.exchanged = mix(seed++);
+		return table;
+	}
+
+	template <int Players, int Teams>
+	constexpr KeyTable<Players, Teams> KEYS = makeKeys<Players, Teams>();
+
+	// XOR of the keys of every cell in the mask
+	inline uint64_t cells(const uint64_t* keys, Bitboard mask)
+	{
+		uint64_t hash = 0;
+		while (!mask.empty())
+			hash ^= keys[mask.popLowest()];
+		return hash;
+	}
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <SFML/Graphics.hpp>
+#include <cfloat>
 #include <string>
 
 #include "GameController.hpp"